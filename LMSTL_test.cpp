@@ -1,6 +1,10 @@
 #include "vector_test.h"
 #include "list_test.h"
 #include "map_test.h"
+#include "queue_test.h"
+#include "alloc_test.h"
+#include "serialize_test.h"
+#include "deque_test.h"
 #include "algo.h"
 
 using namespace lmstl;
@@ -11,6 +15,10 @@ int main() {
 	map_test();
 	vector_test();
 	list_test();
+	deque_test();
+	queue_test();
+	alloc_test();
+	serialize_test();
 
 	system("pause");
 	return 0;
@@ -33,9 +33,17 @@ ForwardIter adjacent_find(ForwardIter beg, ForwardIter end, BinaryPredicate bina
 template <typename InputIter, typename T>
 typename iterator_traits<InputIter>::difference_type count(InputIter beg, InputIter end, const T& val) {
 	typename iterator_traits<InputIter>::difference_type n = 0;
-	for (; beg != end; ++beg)
-		if (*beg == val)
-			++n;
+	if constexpr (is_segmented_iterator_v<InputIter>) {
+		__for_each_segment(beg, end, [&](auto, auto first, auto last) {
+			n += lmstl::count(first, last, val);
+			return true;
+		});
+	}
+	else {
+		for (; beg != end; ++beg)
+			if (*beg == val)
+				++n;
+	}
 	return n;
 }
 
@@ -43,24 +51,60 @@ typename iterator_traits<InputIter>::difference_type count(InputIter beg, InputI
 template <typename InputIter, typename Predicate>
 typename iterator_traits<InputIter>::difference_type count_if(InputIter beg, InputIter end, Predicate pred) {
 	typename iterator_traits<InputIter>::difference_type n = 0;
-	for (; beg != end; ++beg)
-		if (pred(*beg))
-			++n;
+	if constexpr (is_segmented_iterator_v<InputIter>) {
+		__for_each_segment(beg, end, [&](auto, auto first, auto last) {
+			n += lmstl::count_if(first, last, pred);
+			return true;
+		});
+	}
+	else {
+		for (; beg != end; ++beg)
+			if (pred(*beg))
+				++n;
+	}
 	return n;
 }
 
 template <typename InputIter, typename T>
 InputIter find(InputIter beg, InputIter end, const T& val) {
-	while (beg != end && *beg != val)
-		++beg;
-	return beg;
+	if constexpr (is_segmented_iterator_v<InputIter>) {
+		typedef segmented_iterator_traits<InputIter> traits;
+		InputIter ret = end;
+		__for_each_segment(beg, end, [&](auto seg, auto first, auto last) {
+			auto p = lmstl::find(first, last, val);
+			if (p == last)
+				return true;
+			ret = traits::compose(seg, p);
+			return false;
+		});
+		return ret;
+	}
+	else {
+		while (beg != end && *beg != val)
+			++beg;
+		return beg;
+	}
 }
 
 template <typename InputIter, typename Predicate>
 InputIter find_if(InputIter beg, InputIter end, Predicate pred) {
-	while (beg != end && !pred(*beg))
-		++beg;
-	return beg;
+	if constexpr (is_segmented_iterator_v<InputIter>) {
+		typedef segmented_iterator_traits<InputIter> traits;
+		InputIter ret = end;
+		__for_each_segment(beg, end, [&](auto seg, auto first, auto last) {
+			auto p = lmstl::find_if(first, last, pred);
+			if (p == last)
+				return true;
+			ret = traits::compose(seg, p);
+			return false;
+		});
+		return ret;
+	}
+	else {
+		while (beg != end && !pred(*beg))
+			++beg;
+		return beg;
+	}
 }
 
 template <typename InputIter, typename ForwardIter>
@@ -83,8 +127,17 @@ InputIter find_first_of(InputIter beg1, InputIter end1, ForwardIter beg2, Forwar
 
 template <typename InputIter, typename Function>
 Function for_each(InputIter beg, InputIter end, Function f) {
-	for (; beg != end; ++beg)
-		f(*beg);
+	if constexpr (is_segmented_iterator_v<InputIter>) {
+		__for_each_segment(beg, end, [&](auto, auto first, auto last) {
+			for (; first != last; ++first)
+				f(*first);
+			return true;
+		});
+	}
+	else {
+		for (; beg != end; ++beg)
+			f(*beg);
+	}
 	return f;
 }
 
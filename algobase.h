@@ -39,17 +39,68 @@ inline bool equal(InputIter1 beg1,
 	return true;
 }
 
+//单字节元素或各字节全为0的值可以直接memset
+template <typename U>
+inline bool __memset_able(const U& value) {
+	const unsigned char* p = (const unsigned char*)&value;
+	if (sizeof(U) == 1)
+		return true;
+	for (size_t i = 0; i < sizeof(U); ++i) {
+		if (p[i])
+			return false;
+	}
+	return true;
+}
+
+template <typename U, typename Size, typename T>
+inline typename enable_if<std::is_trivially_copyable<U>::value &&
+	std::is_trivially_copy_assignable<U>::value, U*>::type fill_n(U* beg, Size n, const T& value) {
+	if (n <= 0)
+		return beg;
+	const U tmp = value;
+	if (__memset_able(tmp)) {
+		memset(beg, *(const unsigned char*)&tmp, sizeof(U) * size_t(n));
+		return beg + n;
+	}
+	for (; n > 0; --n, ++beg)
+		*beg = tmp;
+	return beg;
+}
+
+template <typename U, typename T>
+inline typename enable_if<std::is_trivially_copyable<U>::value &&
+	std::is_trivially_copy_assignable<U>::value>::type fill(U* beg, U* end, const T& value) {
+	lmstl::fill_n(beg, end - beg, value);
+}
+
 template <typename ForwardIter, typename T>
 inline void fill(ForwardIter beg, ForwardIter end, const T& value) {
-	for (; beg != end; ++beg)
-		*beg = value;
+	if constexpr (is_segmented_iterator_v<ForwardIter>) {
+		__for_each_segment(beg, end, [&](auto, auto first, auto last) {
+			lmstl::fill(first, last, value);
+			return true;
+		});
+	}
+	else {
+		for (; beg != end; ++beg)
+			*beg = value;
+	}
 }
 
 template <typename ForwardIter, typename Size, typename T>
 inline ForwardIter fill_n(ForwardIter beg, Size n, const T& value) {
-	for (; n > 0; --n, ++beg)
-		*beg = value;
-	return beg;
+	if constexpr (is_segmented_iterator_v<ForwardIter>) {
+		if (n <= 0)
+			return beg;
+		ForwardIter end = beg + n;
+		lmstl::fill(beg, end, value);
+		return end;
+	}
+	else {
+		for (; n > 0; --n, ++beg)
+			*beg = value;
+		return beg;
+	}
 }
 
 template <typename ForwardIter1, typename ForwardIter2>
@@ -176,13 +227,54 @@ template <typename T, typename U>
 inline typename enable_if<std::is_same<typename std::remove_const<T>::type, U>::value &&
 	std::is_trivially_copy_assignable<U>::value, U*>::type __copy(T* beg, T* end, U* result) {
 	size_t n = static_cast<size_t>(end - beg);
-	memmove(result, beg, sizeof(U) * n);
+	if (n)
+		memmove(result, beg, sizeof(U) * n);
 	return result + n;
 }
 
+template <typename InputIter, typename OutputIter>
+inline OutputIter copy(InputIter beg, InputIter end, OutputIter result);
+
+//源是分段迭代器时逐段复制，每段都是指针区间
+template <typename SegIter, typename OutputIter>
+inline OutputIter __copy_from_segmented(SegIter beg, SegIter end, OutputIter result) {
+	__for_each_segment(beg, end, [&](auto, auto first, auto last) {
+		result = lmstl::copy(first, last, result);
+		return true;
+	});
+	return result;
+}
+
+//目的是分段迭代器时按目的段的剩余空间切块复制
+template <typename RandomAccessIter, typename SegIter>
+inline SegIter __copy_to_segmented(RandomAccessIter beg, RandomAccessIter end, SegIter result) {
+	typedef segmented_iterator_traits<SegIter> traits;
+	typedef typename iterator_traits<RandomAccessIter>::difference_type Distance;
+	typename traits::segment_iterator seg = traits::segment(result);
+	typename traits::local_iterator cur = traits::local(result);
+	for (Distance n = end - beg; n > 0; ) {
+		const Distance room = traits::end(seg) - cur;
+		const Distance len = n < room ? n : room;
+		lmstl::copy(beg, beg + len, cur);
+		beg += len;
+		n -= len;
+		cur += len;
+		if (n) {
+			++seg;
+			cur = traits::begin(seg);
+		}
+	}
+	return traits::compose(seg, cur);
+}
+
 template <typename InputIter, typename OutputIter>
 inline OutputIter copy(InputIter beg, InputIter end, OutputIter result) {
-	return lmstl::__copy(beg, end, result);
+	if constexpr (is_segmented_iterator_v<InputIter>)
+		return lmstl::__copy_from_segmented(beg, end, result);
+	else if constexpr (is_segmented_iterator_v<OutputIter> && is_random_access_iterator_v<InputIter>)
+		return lmstl::__copy_to_segmented(beg, end, result);
+	else
+		return lmstl::__copy(beg, end, result);
 }
 
 template <typename T, typename U, typename = typename enable_if<
@@ -229,7 +321,7 @@ inline char* copy(const char* beg, const char* end, char* result) {
 
 inline wchar_t* copy(const wchar_t* beg, const wchar_t* end, wchar_t* result) {
 	size_t n = static_cast<size_t>(end - beg);
-	memmove(result, beg, n);
+	memmove(result, beg, sizeof(wchar_t) * n);
 	return result + n;
 }
 
@@ -285,7 +377,7 @@ inline wchar_t* copy_backward(const wchar_t* beg, const wchar_t* end, wchar_t* r
 	size_t n = static_cast<size_t>(end - beg);
 	if (n) {
 		result -= n;
-		memmove(result, beg, n);
+		memmove(result, beg, sizeof(wchar_t) * n);
 	}
 	return result;
 }
@@ -341,7 +433,7 @@ inline wchar_t* move_backward(const wchar_t* beg, const wchar_t* end, wchar_t* r
 	size_t n = static_cast<size_t>(end - beg);
 	if (n) {
 		result -= n;
-		memmove(result, beg, n);
+		memmove(result, beg, sizeof(wchar_t) * n);
 	}
 	return result;
 }
@@ -4,24 +4,73 @@
 #include "exceptdef.h"
 #include <new>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <iomanip>
+#include <type_traits>
+#include <utility>
+
+//__LMSTL_ALLOC_STATSԿͳƣδʱͳƴ벻
+#ifdef __LMSTL_ALLOC_STATS
+#define __LMSTL_ALLOC_STAT(expr) expr
+#else
+#define __LMSTL_ALLOC_STAT(expr)
+#endif // __LMSTL_ALLOC_STATS
 
 namespace lmstl {
 
+	struct malloc_stats {
+		size_t allocs = 0;
+		size_t reallocs = 0;
+		size_t deallocs = 0;
+		size_t oom_calls = 0;
+		size_t bytes_allocated = 0;
+
+		void dump(std::ostream& out = std::cout) const {
+			out << "malloc_alloc: allocs " << allocs << ", reallocs " << reallocs
+				<< ", deallocs " << deallocs << ", oom handler calls " << oom_calls
+				<< ", bytes requested " << bytes_allocated << std::endl;
+		}
+	};
+
 	class malloc_alloc {
 	public:
 		static void* allocate(size_t);
 		static void* reallocate(void*, size_t);
+		static void* reallocate(void* p, size_t, size_t n) { return reallocate(p, n); }
 		static void deallocate(void*, size_t);
 		static void (*set_new_handler(void (*)()))();
+		static malloc_stats stats();
 	private:
 		static void (*oom_handler)();
 		static void* oom_alloc(size_t);
 		static void* oom_realloc(void*, size_t);
+#ifdef __LMSTL_ALLOC_STATS
+		struct counters {
+			std::atomic<size_t> allocs{ 0 };
+			std::atomic<size_t> reallocs{ 0 };
+			std::atomic<size_t> deallocs{ 0 };
+			std::atomic<size_t> oom_calls{ 0 };
+			std::atomic<size_t> bytes_allocated{ 0 };
+		};
+		static counters stat;
+#endif // __LMSTL_ALLOC_STATS
 	};
 
 	void (*malloc_alloc::oom_handler)() = 0;
 
+#ifdef __LMSTL_ALLOC_STATS
+	malloc_alloc::counters malloc_alloc::stat;
+#endif // __LMSTL_ALLOC_STATS
+
 	void* malloc_alloc::allocate(size_t n) {
+		__LMSTL_ALLOC_STAT(stat.allocs.fetch_add(1, std::memory_order_relaxed));
+		__LMSTL_ALLOC_STAT(stat.bytes_allocated.fetch_add(n, std::memory_order_relaxed));
 		void* ret = malloc(n);
 		if (!ret) 
 			ret = oom_alloc(n);
@@ -29,6 +78,7 @@ namespace lmstl {
 	}
 
 	void* malloc_alloc::reallocate(void* p, size_t n) {
+		__LMSTL_ALLOC_STAT(stat.reallocs.fetch_add(1, std::memory_order_relaxed));
 		void* ret = realloc(p, n);
 		if (!ret)
 			ret = oom_realloc(p, n);
@@ -36,9 +86,22 @@ namespace lmstl {
 	}
 
 	void malloc_alloc::deallocate(void* p, size_t n) {
+		__LMSTL_ALLOC_STAT(stat.deallocs.fetch_add(1, std::memory_order_relaxed));
 		free(p);
 	}
 
+	malloc_stats malloc_alloc::stats() {
+		malloc_stats ret;
+#ifdef __LMSTL_ALLOC_STATS
+		ret.allocs = stat.allocs.load(std::memory_order_relaxed);
+		ret.reallocs = stat.reallocs.load(std::memory_order_relaxed);
+		ret.deallocs = stat.deallocs.load(std::memory_order_relaxed);
+		ret.oom_calls = stat.oom_calls.load(std::memory_order_relaxed);
+		ret.bytes_allocated = stat.bytes_allocated.load(std::memory_order_relaxed);
+#endif // __LMSTL_ALLOC_STATS
+		return ret;
+	}
+
 	void (*malloc_alloc::set_new_handler(void (*f)()))() {
 		void (*old)() = oom_handler;
 		oom_handler = f;
@@ -50,6 +113,7 @@ namespace lmstl {
 		for (;;) {
 			if (!oom_handler)
 				__THROW_BAD_ALLOC__;
+			__LMSTL_ALLOC_STAT(stat.oom_calls.fetch_add(1, std::memory_order_relaxed));
 			(*oom_handler)();
 			ret = malloc(n);
 			if (ret)
@@ -62,6 +126,7 @@ namespace lmstl {
 		for (;;) {
 			if (!oom_handler)
 				__THROW_BAD_ALLOC__;
+			__LMSTL_ALLOC_STAT(stat.oom_calls.fetch_add(1, std::memory_order_relaxed));
 			(*oom_handler)();
 			ret = realloc(p, n);
 			if (ret)
@@ -71,67 +136,255 @@ namespace lmstl {
 
 	static const size_t __ALIGN = 8;
 	static const size_t __MAX_BYTES = 512;
-	static const size_t __FREELISTS_NUMS = __MAX_BYTES / __ALIGN;
 
 	union obj {
 		union obj* next_free_list;	//һfreelist
 		char client_data[1];	//ûܿ
 	};
 
-	class pool_alloc {
+	static const int __REFILL_NOBJS = 15;
+	static const size_t __REFILL_BYTES = 16 * 1024;
+	static const size_t __TRIM_INTERVAL = 1024;
+
+	//һrefillĿСȡ__REFILL_NOBJS鰴__REFILL_BYTES㣬2
+	inline int __refill_nobjs(size_t n) {
+		size_t nobj = __REFILL_BYTES / n;
+		return nobj > __REFILL_NOBJS ? __REFILL_NOBJS : (nobj < 2 ? 2 : int(nobj));
+	}
+
+	constexpr size_t __floor_log2(size_t n) {
+		return n <= 1 ? 0 : 1 + __floor_log2(n >> 1);
+	}
+
+	//size classԣindex(n)ΪnֽڵСclasssize(i)ΪiclassĿС
+	//ԲԣAlign, 2*Align, ..., MaxBytes
+	template <size_t Align = __ALIGN, size_t MaxBytes = __MAX_BYTES>
+	struct linear_size_class {
+		static_assert(Align >= sizeof(obj) && !(Align & (Align - 1)), "Align must be a power of two no less than a pointer");
+		static_assert(MaxBytes % Align == 0, "MaxBytes must be a multiple of Align");
+
+		static const size_t align = Align;
+		static const size_t max_bytes = MaxBytes;
+		static const size_t num_classes = MaxBytes / Align;
+
+		static size_t index(size_t n) { return (n + Align - 1) / Align - 1; }
+		static size_t size(size_t i) { return (i + 1) * Align; }
+		static int nobjs(size_t i) { return __refill_nobjs(size(i)); }
+	};
+
+	//βԣǰStepsclass֮ÿ2ٵȷΪStepsclass
+	//Ĭ16, 32, 48, 64, 80, 96, 112, 128, 160, ..., 32768ڲƬ1/Steps
+	template <size_t Align = 16, size_t MaxBytes = 32 * 1024, size_t Steps = 4>
+	struct geometric_size_class {
+	private:
+		static const size_t base = Align * Steps;
+
+	public:
+		static_assert(Align >= sizeof(obj) && !(Align & (Align - 1)), "Align must be a power of two no less than a pointer");
+		static_assert(Steps && !(Steps & (Steps - 1)), "Steps must be a power of two");
+		static_assert(MaxBytes >= base && (MaxBytes >> __floor_log2(MaxBytes / base)) == base, "MaxBytes must be Align * Steps * 2^k");
+
+		static const size_t align = Align;
+		static const size_t max_bytes = MaxBytes;
+		static const size_t num_classes = Steps + Steps * __floor_log2(MaxBytes / base);
+
+		static size_t index(size_t n) {
+			if (n <= base)
+				return (n + Align - 1) / Align - 1;
+			size_t k = __floor_log2(n - 1);
+			size_t group = size_t(1) << k;
+			return Steps + (k - __floor_log2(base)) * Steps + (n - 1 - group) / (group / Steps);
+		}
+		static size_t size(size_t i) {
+			if (i < Steps)
+				return (i + 1) * Align;
+			size_t group = base << ((i - Steps) / Steps);
+			return group + ((i - Steps) % Steps + 1) * (group / Steps);
+		}
+		static int nobjs(size_t i) { return __refill_nobjs(size(i)); }
+	};
+
+#ifdef __LMSTL_USE_GEOMETRIC_SIZE_CLASS
+	typedef geometric_size_class<> default_size_class;
+#else
+	typedef linear_size_class<> default_size_class;
+#endif // __LMSTL_USE_GEOMETRIC_SIZE_CLASS
+
+	//free_blocksΪʱͣfree_listеĿbatch_*ֻthread_allocм
+	template <class SizeClass>
+	struct basic_pool_stats {
+		struct size_class {
+			size_t block_size = 0;
+			size_t allocs = 0;
+			size_t free_list_hits = 0;
+			size_t deallocs = 0;
+			size_t refills = 0;
+			size_t batch_fetches = 0;
+			size_t batch_flushes = 0;
+			size_t free_blocks = 0;
+		};
+		size_class classes[SizeClass::num_classes];
+		size_t large_allocs = 0;
+		size_t large_deallocs = 0;
+		size_t chunk_allocs = 0;
+		size_t chunk_bytes = 0;
+		size_t trims = 0;
+		size_t chunks_released = 0;
+		size_t bytes_released = 0;
+		size_t pool_size = 0;
+		size_t pool_left = 0;
+		size_t chunks = 0;
+
+		size_t free_bytes() const {
+			size_t ret = pool_left;
+			for (size_t i = 0; i < SizeClass::num_classes; ++i)
+				ret += classes[i].free_blocks * classes[i].block_size;
+			return ret;
+		}
+
+		void dump(std::ostream& out = std::cout) const {
+			out << "pool: " << chunks << " chunks, " << pool_size << " bytes pooled, "
+				<< free_bytes() << " bytes free, " << pool_left << " bytes uncarved\n";
+			out << "      chunk allocs " << chunk_allocs << " (" << chunk_bytes << " bytes), trims " << trims
+				<< ", chunks released " << chunks_released << " (" << bytes_released << " bytes)\n";
+			out << "      large allocs " << large_allocs << ", large deallocs " << large_deallocs << "\n";
+			out << std::setw(8) << "size" << std::setw(12) << "allocs" << std::setw(12) << "hits"
+				<< std::setw(12) << "deallocs" << std::setw(10) << "refills" << std::setw(10) << "fetches"
+				<< std::setw(10) << "flushes" << std::setw(10) << "free" << "\n";
+			for (size_t i = 0; i < SizeClass::num_classes; ++i) {
+				const size_class& c = classes[i];
+				if (!c.allocs && !c.deallocs && !c.free_blocks)
+					continue;
+				out << std::setw(8) << c.block_size << std::setw(12) << c.allocs << std::setw(12) << c.free_list_hits
+					<< std::setw(12) << c.deallocs << std::setw(10) << c.refills << std::setw(10) << c.batch_fetches
+					<< std::setw(10) << c.batch_flushes << std::setw(10) << c.free_blocks << "\n";
+			}
+			out.flush();
+		}
+	};
+
+	typedef basic_pool_stats<default_size_class> pool_stats;
+
+	template <int inst, class SizeClass = default_size_class>
+	class basic_thread_alloc;
+
+	template <bool threads, int inst, class SizeClass = default_size_class>
+	class basic_pool_alloc {
+		friend class basic_thread_alloc<inst, SizeClass>;
 	public:
 		static void* allocate(size_t);
 
-		//void* reallocate(void*, size_t);
+		static void* reallocate(void*, size_t, size_t);
 
 		static void deallocate(void*, size_t);
 
+		static size_t trim();
+		static size_t set_pool_limit(size_t);
+		static void start_reclaim(unsigned int);
+		static void stop_reclaim();
+
+		static basic_pool_stats<SizeClass> stats();
+
 	private:
 		static size_t ROUND_UP(size_t);
 		static size_t FREELIST_INDEX(size_t);
 
 	public:
-		static obj* free_list[__FREELISTS_NUMS];
+		static obj* free_list[SizeClass::num_classes];
 		static char* start_pos;
 		static char* end_pos;
 		static size_t pool_size;
 
 	private:
+		//ÿchunkͷ¼СtrimʱжchunkǷȫ
+		struct chunk_header {
+			chunk_header* next;
+			size_t bytes;
+		};
+		static const size_t __CHUNK_HEADER = (sizeof(chunk_header) + 15) & ~size_t(15);
+
+		static chunk_header* chunk_list;
+		static size_t pool_limit;
+		static size_t trim_countdown;
+#ifdef __LMSTL_ALLOC_STATS
+		static basic_pool_stats<SizeClass> stat;
+#endif // __LMSTL_ALLOC_STATS
+
+		struct pool_lock {
+			pool_lock() { if (threads) mtx.lock(); }
+			~pool_lock() { if (threads) mtx.unlock(); }
+		};
+		static std::mutex mtx;
+
+		struct reclaimer {
+			std::thread worker;
+			std::mutex mtx;
+			std::condition_variable cv;
+			bool running = false;
+			void stop();
+			~reclaimer() { stop(); }
+		};
+		static reclaimer& get_reclaimer();
+
 		static void* refill(size_t);
 		static char* chunk_alloc(size_t, int&);
+		static void stash(char*, size_t);
+		static obj* fetch(size_t, int&);
+		static void release(obj*, obj*, size_t);
+		static size_t trim_aux();
+		static void reclaim_check();
 	};
 
-	size_t pool_alloc::pool_size = 0;
+	template <bool threads, int inst, class SizeClass>
+	size_t basic_pool_alloc<threads, inst, SizeClass>::pool_size = 0;
 
-	char* pool_alloc::start_pos = 0;
+	template <bool threads, int inst, class SizeClass>
+	char* basic_pool_alloc<threads, inst, SizeClass>::start_pos = 0;
 
-	char* pool_alloc::end_pos = 0;
+	template <bool threads, int inst, class SizeClass>
+	char* basic_pool_alloc<threads, inst, SizeClass>::end_pos = 0;
 
-	obj* pool_alloc::free_list[__FREELISTS_NUMS] = {
-	0,0,0,0,0,0,0,0,
-	0,0,0,0,0,0,0,0,
-	0,0,0,0,0,0,0,0,
-	0,0,0,0,0,0,0,0,
-	0,0,0,0,0,0,0,0,
-	0,0,0,0,0,0,0,0,
-	0,0,0,0,0,0,0,0,
-	0,0,0,0,0,0,0,0
-	};
+	template <bool threads, int inst, class SizeClass>
+	obj* basic_pool_alloc<threads, inst, SizeClass>::free_list[SizeClass::num_classes] = { 0 };
+
+	template <bool threads, int inst, class SizeClass>
+	typename basic_pool_alloc<threads, inst, SizeClass>::chunk_header* basic_pool_alloc<threads, inst, SizeClass>::chunk_list = 0;
 
-	size_t pool_alloc::ROUND_UP(size_t n) {
-		return (((n)+__ALIGN - 1) & ~(__ALIGN - 1));
+	template <bool threads, int inst, class SizeClass>
+	size_t basic_pool_alloc<threads, inst, SizeClass>::pool_limit = 0;
+
+	template <bool threads, int inst, class SizeClass>
+	size_t basic_pool_alloc<threads, inst, SizeClass>::trim_countdown = __TRIM_INTERVAL;
+
+#ifdef __LMSTL_ALLOC_STATS
+	template <bool threads, int inst, class SizeClass>
+	basic_pool_stats<SizeClass> basic_pool_alloc<threads, inst, SizeClass>::stat;
+#endif // __LMSTL_ALLOC_STATS
+
+	template <bool threads, int inst, class SizeClass>
+	std::mutex basic_pool_alloc<threads, inst, SizeClass>::mtx;
+
+	template <bool threads, int inst, class SizeClass>
+	size_t basic_pool_alloc<threads, inst, SizeClass>::ROUND_UP(size_t n) {
+		return SizeClass::size(SizeClass::index(n));
 	}
 
-	size_t pool_alloc::FREELIST_INDEX(size_t n) {
-		return (((n)+__ALIGN - 1) / __ALIGN - 1);
+	template <bool threads, int inst, class SizeClass>
+	size_t basic_pool_alloc<threads, inst, SizeClass>::FREELIST_INDEX(size_t n) {
+		return SizeClass::index(n);
 	}
 
-	void* pool_alloc::allocate(size_t n) {
-		if (n > __MAX_BYTES) 
+	template <bool threads, int inst, class SizeClass>
+	void* basic_pool_alloc<threads, inst, SizeClass>::allocate(size_t n) {
+		if (n > SizeClass::max_bytes) {
+			__LMSTL_ALLOC_STAT({ pool_lock lock; ++stat.large_allocs; });
 			return malloc_alloc::allocate(n);
+		}
 
 		obj** ptr_free_list;
 		obj* result;
+		pool_lock lock;
+		__LMSTL_ALLOC_STAT(++stat.classes[FREELIST_INDEX(n)].allocs);
 		ptr_free_list = free_list + FREELIST_INDEX(n);
 		result = *ptr_free_list;
 
@@ -139,25 +392,54 @@ namespace lmstl {
 			void* r = refill(ROUND_UP(n));
 			return r;
 		}
+		__LMSTL_ALLOC_STAT(++stat.classes[FREELIST_INDEX(n)].free_list_hits);
 		*ptr_free_list = result->next_free_list;
 
 		return (result);
 	}
 
-	void pool_alloc::deallocate(void* p, size_t n) {
-		if (n > __MAX_BYTES || !n) {
+	template <bool threads, int inst, class SizeClass>
+	void basic_pool_alloc<threads, inst, SizeClass>::deallocate(void* p, size_t n) {
+		if (n > SizeClass::max_bytes || !n) {
+			__LMSTL_ALLOC_STAT({ pool_lock lock; ++stat.large_deallocs; });
 			malloc_alloc::deallocate(p, n);
 			return;
 		}
 
 		obj* q = (obj*)p;
+		pool_lock lock;
+		__LMSTL_ALLOC_STAT(++stat.classes[FREELIST_INDEX(n)].deallocs);
 		obj** ptr_free_list = free_list + FREELIST_INDEX(n);
 		q->next_free_list = *ptr_free_list;
 		*ptr_free_list = q;
+		reclaim_check();
 	}
 
-	void* pool_alloc::refill(size_t n) {
-		int nobj = 15;
+	//new_szΪ0ʱͷp0˶Ǵʱֱreallocͬһsize classԭطأ¿
+	template <bool threads, int inst, class SizeClass>
+	void* basic_pool_alloc<threads, inst, SizeClass>::reallocate(void* p, size_t old_sz, size_t new_sz) {
+		if (!new_sz) {
+			if (p && old_sz)
+				deallocate(p, old_sz);
+			return 0;
+		}
+		if (!p || !old_sz)
+			return allocate(new_sz);
+		if (old_sz > SizeClass::max_bytes && new_sz > SizeClass::max_bytes)
+			return malloc_alloc::reallocate(p, new_sz);
+		if (old_sz <= SizeClass::max_bytes && new_sz <= SizeClass::max_bytes
+			&& FREELIST_INDEX(old_sz) == FREELIST_INDEX(new_sz))
+			return p;
+		void* ret = allocate(new_sz);
+		memcpy(ret, p, old_sz < new_sz ? old_sz : new_sz);
+		deallocate(p, old_sz);
+		return ret;
+	}
+
+	template <bool threads, int inst, class SizeClass>
+	void* basic_pool_alloc<threads, inst, SizeClass>::refill(size_t n) {
+		__LMSTL_ALLOC_STAT(++stat.classes[FREELIST_INDEX(n)].refills);
+		int nobj = SizeClass::nobjs(FREELIST_INDEX(n));
 		char* chunk = chunk_alloc(n, nobj);
 
 		if (nobj == 1)
@@ -176,7 +458,8 @@ namespace lmstl {
 		return (chunk);
 	}
 
-	char* pool_alloc::chunk_alloc(size_t n, int& nobj) {
+	template <bool threads, int inst, class SizeClass>
+	char* basic_pool_alloc<threads, inst, SizeClass>::chunk_alloc(size_t n, int& nobj) {
 		size_t pool_left = end_pos - start_pos;
 		char* ret;
 		if (pool_left >= n * nobj) {
@@ -191,36 +474,513 @@ namespace lmstl {
 			return ret;
 		}
 		else {
-			size_t bytes_needed = (n << 1) * nobj + ROUND_UP(pool_size >> 4);
-			if (pool_left > 0) {
-				obj** ptr_free_list = free_list + FREELIST_INDEX(pool_left);
-				((obj*)start_pos)->next_free_list = *ptr_free_list;
-				*ptr_free_list = (obj*)start_pos;
+			size_t bytes_needed = (n << 1) * nobj + (((pool_size >> 4) + SizeClass::align - 1) & ~(SizeClass::align - 1));
+			if (pool_limit && pool_size + bytes_needed > pool_limit) {
+				trim_aux();
+				pool_left = end_pos - start_pos;
+				if (pool_size + bytes_needed > pool_limit)
+					bytes_needed = n * nobj;
 			}
-			start_pos = (char*)malloc(bytes_needed);
+			if (pool_left > 0)
+				stash(start_pos, pool_left);
+			chunk_header* chunk = (chunk_header*)malloc(__CHUNK_HEADER + bytes_needed);
+			start_pos = chunk ? (char*)chunk + __CHUNK_HEADER : 0;
 			if (!start_pos) {
 				obj** ptr_free_list;
 				obj* p;
-				for (int i = n; i < __MAX_BYTES; i += __ALIGN){//ע˴Ǵnʼܰпϵһ𣻷ѭ
-					ptr_free_list = free_list + FREELIST_INDEX(i);
+				for (size_t i = FREELIST_INDEX(n); i < SizeClass::num_classes; ++i){//ע˴Ǵnʼܰпϵһ𣻷ѭ
+					ptr_free_list = free_list + i;
 					p = *ptr_free_list;
 					if (p) {
 						*ptr_free_list = p->next_free_list;
 						start_pos = (char*)p;
-						end_pos = start_pos + i;
+						end_pos = start_pos + SizeClass::size(i);
 						return (chunk_alloc(n, nobj));
 					}
 				}
 				end_pos = 0;
 				__THROW_BAD_ALLOC__;
 			}
+			chunk->bytes = bytes_needed;
+			chunk->next = chunk_list;
+			chunk_list = chunk;
+			__LMSTL_ALLOC_STAT(++stat.chunk_allocs);
+			__LMSTL_ALLOC_STAT(stat.chunk_bytes += bytes_needed);
 			pool_size += bytes_needed;
 			end_pos = start_pos + bytes_needed;
 			return chunk_alloc(n, nobj);
 		}
 	}
 
+	//ڴʣͷӴСclassзֹfree_list֤trimʱchunkֽԵ
+	template <bool threads, int inst, class SizeClass>
+	void basic_pool_alloc<threads, inst, SizeClass>::stash(char* p, size_t left) {
+		while (left >= SizeClass::align) {
+			size_t i = SizeClass::index(left);
+			if (SizeClass::size(i) > left)
+				--i;
+			obj** ptr_free_list = free_list + i;
+			((obj*)p)->next_free_list = *ptr_free_list;
+			*ptr_free_list = (obj*)p;
+			p += SizeClass::size(i);
+			left -= SizeClass::size(i);
+		}
+	}
+
+	template <bool threads, int inst, class SizeClass>
+	obj* basic_pool_alloc<threads, inst, SizeClass>::fetch(size_t n, int& nobj) {
+		obj** ptr_free_list = free_list + FREELIST_INDEX(n);
+		obj* head = *ptr_free_list;
+		obj* curr;
+		if (head) {
+			int cnt = 1;
+			for (curr = head; cnt < nobj && curr->next_free_list; ++cnt)
+				curr = curr->next_free_list;
+			*ptr_free_list = curr->next_free_list;
+			curr->next_free_list = 0;
+			nobj = cnt;
+			return head;
+		}
+		__LMSTL_ALLOC_STAT(++stat.classes[FREELIST_INDEX(n)].refills);
+		head = curr = (obj*)chunk_alloc(n, nobj);
+		for (int i = 1; i < nobj; i++) {
+			curr->next_free_list = (obj*)((char*)curr + n);
+			curr = curr->next_free_list;
+		}
+		curr->next_free_list = 0;
+		return head;
+	}
+
+	template <bool threads, int inst, class SizeClass>
+	void basic_pool_alloc<threads, inst, SizeClass>::release(obj* first, obj* last, size_t n) {
+		obj** ptr_free_list = free_list + FREELIST_INDEX(n);
+		last->next_free_list = *ptr_free_list;
+		*ptr_free_list = first;
+		reclaim_check();
+	}
+
+	template <bool threads, int inst, class SizeClass>
+	void basic_pool_alloc<threads, inst, SizeClass>::reclaim_check() {
+		if (pool_limit && pool_size > pool_limit && !--trim_countdown) {
+			trim_countdown = __TRIM_INTERVAL;
+			trim_aux();
+		}
+	}
+
+	template <bool threads, int inst, class SizeClass>
+	size_t basic_pool_alloc<threads, inst, SizeClass>::trim() {
+		pool_lock lock;
+		return trim_aux();
+	}
+
+	//Ƴchunkֽ0ʾƣؾֵ
+	template <bool threads, int inst, class SizeClass>
+	size_t basic_pool_alloc<threads, inst, SizeClass>::set_pool_limit(size_t n) {
+		pool_lock lock;
+		size_t old = pool_limit;
+		pool_limit = n;
+		return old;
+	}
+
+	//ͷп鶼free_listδзֵڴأеchunkع黹ϵͳֽ
+	template <bool threads, int inst, class SizeClass>
+	size_t basic_pool_alloc<threads, inst, SizeClass>::trim_aux() {
+		size_t nchunks = 0;
+		for (chunk_header* c = chunk_list; c; c = c->next)
+			++nchunks;
+		if (!nchunks)
+			return 0;
+
+		chunk_header** chunks = (chunk_header**)malloc(nchunks * sizeof(chunk_header*));
+		size_t* free_bytes = (size_t*)malloc(nchunks * sizeof(size_t));
+		if (!chunks || !free_bytes) {
+			free(chunks);
+			free(free_bytes);
+			return 0;
+		}
+		size_t k = 0;
+		for (chunk_header* c = chunk_list; c; c = c->next) {
+			chunks[k] = c;
+			free_bytes[k++] = 0;
+		}
+		qsort(chunks, nchunks, sizeof(chunk_header*), [](const void* a, const void* b) {
+			char* x = *(char**)a;
+			char* y = *(char**)b;
+			return x < y ? -1 : (y < x ? 1 : 0);
+		});
+		auto owner = [&](char* p) {
+			size_t lo = 0, hi = nchunks;
+			while (hi - lo > 1) {
+				size_t mid = (lo + hi) >> 1;
+				if ((char*)chunks[mid] <= p)
+					lo = mid;
+				else
+					hi = mid;
+			}
+			return lo;
+		};
+
+		for (size_t i = 0; i < SizeClass::num_classes; ++i)
+			for (obj* p = free_list[i]; p; p = p->next_free_list)
+				free_bytes[owner((char*)p)] += SizeClass::size(i);
+		if (end_pos != start_pos)
+			free_bytes[owner(start_pos)] += end_pos - start_pos;
+
+		size_t released = 0;
+		for (k = 0; k < nchunks; ++k) {
+			if (free_bytes[k] == chunks[k]->bytes)
+				free_bytes[k] = size_t(-1);
+		}
+		for (size_t i = 0; i < SizeClass::num_classes; ++i) {
+			obj** ptr_free_list = free_list + i;
+			while (*ptr_free_list) {
+				if (free_bytes[owner((char*)*ptr_free_list)] == size_t(-1))
+					*ptr_free_list = (*ptr_free_list)->next_free_list;
+				else
+					ptr_free_list = &(*ptr_free_list)->next_free_list;
+			}
+		}
+		if (end_pos != start_pos && free_bytes[owner(start_pos)] == size_t(-1))
+			start_pos = end_pos = 0;
+
+		chunk_header** link = &chunk_list;
+		while (*link) {
+			chunk_header* c = *link;
+			size_t idx = owner((char*)c);
+			if (free_bytes[idx] == size_t(-1)) {
+				*link = c->next;
+				pool_size -= c->bytes;
+				released += __CHUNK_HEADER + c->bytes;
+				__LMSTL_ALLOC_STAT(++stat.chunks_released);
+				free(c);
+			}
+			else
+				link = &c->next;
+		}
+		free(chunks);
+		free(free_bytes);
+		__LMSTL_ALLOC_STAT(++stat.trims);
+		__LMSTL_ALLOC_STAT(stat.bytes_released += released);
+		return released;
+	}
+
+	template <bool threads, int inst, class SizeClass>
+	basic_pool_stats<SizeClass> basic_pool_alloc<threads, inst, SizeClass>::stats() {
+		pool_lock lock;
+		basic_pool_stats<SizeClass> ret;
+#ifdef __LMSTL_ALLOC_STATS
+		ret = stat;
+#endif // __LMSTL_ALLOC_STATS
+		for (size_t i = 0; i < SizeClass::num_classes; ++i) {
+			ret.classes[i].block_size = SizeClass::size(i);
+			ret.classes[i].free_blocks = 0;
+			for (obj* p = free_list[i]; p; p = p->next_free_list)
+				++ret.classes[i].free_blocks;
+		}
+		for (chunk_header* c = chunk_list; c; c = c->next)
+			++ret.chunks;
+		ret.pool_size = pool_size;
+		ret.pool_left = end_pos - start_pos;
+		return ret;
+	}
+
+	template <bool threads, int inst, class SizeClass>
+	typename basic_pool_alloc<threads, inst, SizeClass>::reclaimer& basic_pool_alloc<threads, inst, SizeClass>::get_reclaimer() {
+		static reclaimer r;
+		return r;
+	}
+
+	//̨߳ÿmsһtrimڼڴ
+	template <bool threads, int inst, class SizeClass>
+	void basic_pool_alloc<threads, inst, SizeClass>::start_reclaim(unsigned int ms) {
+		static_assert(threads, "background reclaim requires a thread-safe pool");
+		reclaimer& r = get_reclaimer();
+		std::lock_guard<std::mutex> guard(r.mtx);
+		if (r.running)
+			return;
+		r.running = true;
+		r.worker = std::thread([ms, &r]() {
+			std::unique_lock<std::mutex> guard(r.mtx);
+			while (r.running) {
+				r.cv.wait_for(guard, std::chrono::milliseconds(ms));
+				if (r.running)
+					trim();
+			}
+		});
+	}
+
+	template <bool threads, int inst, class SizeClass>
+	void basic_pool_alloc<threads, inst, SizeClass>::stop_reclaim() {
+		get_reclaimer().stop();
+	}
+
+	template <bool threads, int inst, class SizeClass>
+	void basic_pool_alloc<threads, inst, SizeClass>::reclaimer::stop() {
+		{
+			std::lock_guard<std::mutex> guard(mtx);
+			if (!running)
+				return;
+			running = false;
+		}
+		cv.notify_all();
+		if (worker.joinable())
+			worker.join();
+	}
+
+	typedef basic_pool_alloc<false, 0> pool_alloc;
+
+	template <int inst, class SizeClass>
+	class basic_thread_alloc {
+	public:
+		static void* allocate(size_t);
+		static void deallocate(void*, size_t);
+		static void* reallocate(void*, size_t, size_t);
+
+		static size_t trim();
+		static size_t set_pool_limit(size_t n) { return central::set_pool_limit(n); }
+		static void start_reclaim(unsigned int ms) { central::start_reclaim(ms); }
+		static void stop_reclaim() { central::stop_reclaim(); }
+
+		static basic_pool_stats<SizeClass> stats();
+
+	private:
+		typedef basic_pool_alloc<true, inst, SizeClass> central;
+
+		struct thread_cache {
+			obj* free_list[SizeClass::num_classes];
+			int free_count[SizeClass::num_classes];
+#ifdef __LMSTL_ALLOC_STATS
+			typename basic_pool_stats<SizeClass>::size_class stat[SizeClass::num_classes];
+			size_t large_allocs = 0;
+			size_t large_deallocs = 0;
+			void fold(size_t);
+#endif // __LMSTL_ALLOC_STATS
+			thread_cache();
+			~thread_cache();
+			void release_all();
+		};
+		static thread_local thread_cache cache;
+		//cache֮ٶĳԱ߳˳ʱ״̬һƽı
+		enum { cache_unused, cache_alive, cache_dead };
+		static thread_local unsigned char cache_state;
+		//̵߳Ļʱ0һεʱ컺
+		static thread_cache* local_cache() { return cache_state == cache_dead ? 0 : &cache; }
+
+		static void* refill(size_t);
+		static void flush(size_t, int);
+	};
+
+	template <int inst, class SizeClass>
+	thread_local typename basic_thread_alloc<inst, SizeClass>::thread_cache basic_thread_alloc<inst, SizeClass>::cache;
+
+	template <int inst, class SizeClass>
+	thread_local unsigned char basic_thread_alloc<inst, SizeClass>::cache_state = cache_unused;
+
+	template <int inst, class SizeClass>
+	basic_thread_alloc<inst, SizeClass>::thread_cache::thread_cache() {
+		cache_state = cache_alive;
+		for (size_t i = 0; i < SizeClass::num_classes; ++i) {
+			free_list[i] = 0;
+			free_count[i] = 0;
+		}
+	}
+
+	template <int inst, class SizeClass>
+	basic_thread_alloc<inst, SizeClass>::thread_cache::~thread_cache() {
+		cache_state = cache_dead;
+		release_all();
+	}
+
+#ifdef __LMSTL_ALLOC_STATS
+	//ѱ̵߳ļĳأʱĳص
+	template <int inst, class SizeClass>
+	void basic_thread_alloc<inst, SizeClass>::thread_cache::fold(size_t i) {
+		typename basic_pool_stats<SizeClass>::size_class& dst = central::stat.classes[i];
+		dst.allocs += stat[i].allocs;
+		dst.free_list_hits += stat[i].free_list_hits;
+		dst.deallocs += stat[i].deallocs;
+		dst.batch_fetches += stat[i].batch_fetches;
+		dst.batch_flushes += stat[i].batch_flushes;
+		stat[i] = typename basic_pool_stats<SizeClass>::size_class();
+	}
+#endif // __LMSTL_ALLOC_STATS
+
+	template <int inst, class SizeClass>
+	void basic_thread_alloc<inst, SizeClass>::thread_cache::release_all() {
+		typename central::pool_lock lock;
+		__LMSTL_ALLOC_STAT(central::stat.large_allocs += large_allocs);
+		__LMSTL_ALLOC_STAT(central::stat.large_deallocs += large_deallocs);
+		__LMSTL_ALLOC_STAT(large_allocs = large_deallocs = 0);
+		for (size_t i = 0; i < SizeClass::num_classes; ++i) {
+			__LMSTL_ALLOC_STAT(fold(i));
+			obj* first = free_list[i];
+			if (!first)
+				continue;
+			obj* last = first;
+			while (last->next_free_list)
+				last = last->next_free_list;
+			central::release(first, last, SizeClass::size(i));
+			free_list[i] = 0;
+			free_count[i] = 0;
+		}
+	}
+
+	template <int inst, class SizeClass>
+	void* basic_thread_alloc<inst, SizeClass>::allocate(size_t n) {
+		thread_cache* c = local_cache();
+		if (n > SizeClass::max_bytes) {
+			__LMSTL_ALLOC_STAT(if (c) ++c->large_allocs);
+			return malloc_alloc::allocate(n);
+		}
+
+		if (!c)
+			return central::allocate(n);
+		size_t index = central::FREELIST_INDEX(n);
+		__LMSTL_ALLOC_STAT(++c->stat[index].allocs);
+		obj* result = c->free_list[index];
+		if (!result)
+			return refill(central::ROUND_UP(n));
+		__LMSTL_ALLOC_STAT(++c->stat[index].free_list_hits);
+		c->free_list[index] = result->next_free_list;
+		--c->free_count[index];
+		return (result);
+	}
+
+	template <int inst, class SizeClass>
+	void basic_thread_alloc<inst, SizeClass>::deallocate(void* p, size_t n) {
+		thread_cache* c = local_cache();
+		if (n > SizeClass::max_bytes || !n) {
+			__LMSTL_ALLOC_STAT(if (c) ++c->large_deallocs);
+			malloc_alloc::deallocate(p, n);
+			return;
+		}
+
+		if (!c) {
+			central::deallocate(p, n);
+			return;
+		}
+		size_t index = central::FREELIST_INDEX(n);
+		__LMSTL_ALLOC_STAT(++c->stat[index].deallocs);
+		obj* q = (obj*)p;
+		q->next_free_list = c->free_list[index];
+		c->free_list[index] = q;
+		if (++c->free_count[index] >= (SizeClass::nobjs(index) << 1))
+			flush(index, SizeClass::nobjs(index));
+	}
+
+	template <int inst, class SizeClass>
+	void* basic_thread_alloc<inst, SizeClass>::reallocate(void* p, size_t old_sz, size_t new_sz) {
+		if (!new_sz) {
+			if (p && old_sz)
+				deallocate(p, old_sz);
+			return 0;
+		}
+		if (!p || !old_sz)
+			return allocate(new_sz);
+		if (old_sz > SizeClass::max_bytes && new_sz > SizeClass::max_bytes)
+			return malloc_alloc::reallocate(p, new_sz);
+		if (old_sz <= SizeClass::max_bytes && new_sz <= SizeClass::max_bytes
+			&& SizeClass::index(old_sz) == SizeClass::index(new_sz))
+			return p;
+		void* ret = allocate(new_sz);
+		memcpy(ret, p, old_sz < new_sz ? old_sz : new_sz);
+		deallocate(p, old_sz);
+		return ret;
+	}
+
+	//Ȱѱ̻߳Ŀȫĳأĳͷſchunk
+	template <int inst, class SizeClass>
+	size_t basic_thread_alloc<inst, SizeClass>::trim() {
+		if (thread_cache* c = local_cache())
+			c->release_all();
+		return central::trim();
+	}
+
+	template <int inst, class SizeClass>
+	void* basic_thread_alloc<inst, SizeClass>::refill(size_t n) {
+		size_t index = central::FREELIST_INDEX(n);
+		int nobj = SizeClass::nobjs(index);
+		obj* chunk;
+		{
+			typename central::pool_lock lock;
+			__LMSTL_ALLOC_STAT(++cache.stat[index].batch_fetches);
+			__LMSTL_ALLOC_STAT(cache.fold(index));
+			chunk = central::fetch(n, nobj);
+		}
+		cache.free_list[index] = chunk->next_free_list;
+		cache.free_count[index] = nobj - 1;
+		return (chunk);
+	}
+
+	template <int inst, class SizeClass>
+	void basic_thread_alloc<inst, SizeClass>::flush(size_t index, int nobj) {
+		thread_cache& c = cache;
+		obj* first = c.free_list[index];
+		obj* last = first;
+		for (int i = 1; i < nobj; ++i)
+			last = last->next_free_list;
+		c.free_list[index] = last->next_free_list;
+		c.free_count[index] -= nobj;
+		typename central::pool_lock lock;
+		__LMSTL_ALLOC_STAT(++c.stat[index].batch_flushes);
+		__LMSTL_ALLOC_STAT(c.fold(index));
+		central::release(first, last, SizeClass::size(index));
+	}
+
+	//̻߳δĳصļп鲻ڿ֮
+	template <int inst, class SizeClass>
+	basic_pool_stats<SizeClass> basic_thread_alloc<inst, SizeClass>::stats() {
+		basic_pool_stats<SizeClass> ret = central::stats();
+		const thread_cache* c = local_cache();
+		if (!c)
+			return ret;
+		for (size_t i = 0; i < SizeClass::num_classes; ++i) {
+			ret.classes[i].free_blocks += c->free_count[i];
+#ifdef __LMSTL_ALLOC_STATS
+			ret.classes[i].allocs += c->stat[i].allocs;
+			ret.classes[i].free_list_hits += c->stat[i].free_list_hits;
+			ret.classes[i].deallocs += c->stat[i].deallocs;
+			ret.classes[i].batch_fetches += c->stat[i].batch_fetches;
+			ret.classes[i].batch_flushes += c->stat[i].batch_flushes;
+#endif // __LMSTL_ALLOC_STATS
+		}
+		__LMSTL_ALLOC_STAT(ret.large_allocs += c->large_allocs);
+		__LMSTL_ALLOC_STAT(ret.large_deallocs += c->large_deallocs);
+		return ret;
+	}
+
+	typedef basic_thread_alloc<0> thread_alloc;
+
+#ifdef __LMSTL_USE_THREAD_ALLOC
+	typedef thread_alloc alloc;
+#else
 	typedef pool_alloc alloc;
+#endif // __LMSTL_USE_THREAD_ALLOC
+
+#ifndef __LMSTL_CACHE_LINE_SIZE
+#define __LMSTL_CACHE_LINE_SIZE 64
+#endif
+
+	//صĿ鰴Alignֽڶ루AlignΪ2ݣҪаڷʱʹãd
+	template <size_t Align>
+	class basic_aligned_alloc {
+		static_assert(Align && !(Align & (Align - 1)), "alignment must be a power of two");
+	public:
+		static void* allocate(size_t n) {
+			return ::operator new(n, std::align_val_t(Align));
+		}
+		static void deallocate(void* p, size_t) {
+			::operator delete(p, std::align_val_t(Align));
+		}
+	};
+
+	typedef basic_aligned_alloc<__LMSTL_CACHE_LINE_SIZE> cacheline_alloc;
+
+	template <typename Alloc, typename = void>
+	struct __has_reallocate : std::false_type {};
+
+	template <typename Alloc>
+	struct __has_reallocate<Alloc, std::void_t<decltype(std::declval<const Alloc&>().reallocate((void*)0, size_t(0), size_t(0)))>> : std::true_type {};
 
 	template<typename T, typename Alloc = alloc>
 	class simple_alloc {
@@ -231,6 +991,91 @@ namespace lmstl {
 		static void deallocate(T* p, const size_t n) {
 			Alloc::deallocate(p, n * sizeof(T));
 		}
+
+		//ͨʵ䣬״̬ʹ
+		static T* allocate(const Alloc& a, const size_t n) {
+			return n ? (T*)a.allocate(n * sizeof(T)) : 0;
+		}
+		static void deallocate(const Alloc& a, T* p, const size_t n) {
+			a.deallocate(p, n * sizeof(T));
+		}
+
+		//ֻڿƽضλTAllocreallocate(p, old, new)ʱԭչ¿memcpy
+		static T* reallocate(T* p, const size_t old_n, const size_t new_n) {
+			return reallocate(Alloc(), p, old_n, new_n);
+		}
+		static T* reallocate(const Alloc& a, T* p, const size_t old_n, const size_t new_n) {
+			return (T*)__reallocate(a, p, old_n * sizeof(T), new_n * sizeof(T), __has_reallocate<Alloc>());
+		}
+
+	private:
+		static void* __reallocate(const Alloc& a, void* p, size_t old_sz, size_t new_sz, std::true_type) {
+			return a.reallocate(p, old_sz, new_sz);
+		}
+		static void* __reallocate(const Alloc& a, void* p, size_t old_sz, size_t new_sz, std::false_type) {
+			void* ret = a.allocate(new_sz);
+			if (p) {
+				memcpy(ret, p, old_sz < new_sz ? old_sz : new_sz);
+				a.deallocate(p, old_sz);
+			}
+			return ret;
+		}
+	};
+
+	//״̬һallocate(n)/deallocate(p, n)ڴԴƺָͬһԴ
+	template <typename Resource>
+	class alloc_ref {
+	public:
+		alloc_ref(Resource& r): res(&r) {}
+
+		void* allocate(size_t n) const { return res->allocate(n); }
+		void deallocate(void* p, size_t n) const { res->deallocate(p, n); }
+		template <typename R = Resource>
+		auto reallocate(void* p, size_t old_sz, size_t new_sz) const -> decltype(std::declval<R&>().reallocate(p, old_sz, new_sz)) {
+			return res->reallocate(p, old_sz, new_sz);
+		}
+
+		Resource* resource() const { return res; }
+
+		bool operator==(const alloc_ref& x) const { return res == x.res; }
+		bool operator!=(const alloc_ref& x) const { return res != x.res; }
+
+	private:
+		Resource* res;
+	};
+
+	//Ļࡣ״̬ࣩռռ䣬ÿõʱʱһ
+	//״̬һʵƹʱƣƶʱƶswapʱֵʱԵķ
+	template <typename Alloc, bool = std::is_empty<Alloc>::value>
+	class alloc_holder {
+	public:
+		alloc_holder() {}
+		explicit alloc_holder(const Alloc&) {}
+
+		Alloc get_alloc() const { return Alloc(); }
+		void swap_alloc(alloc_holder&) {}
+	};
+
+	template <typename Alloc>
+	class alloc_holder<Alloc, false> {
+	public:
+		alloc_holder():
+			alloc_inst() {}
+		explicit alloc_holder(const Alloc& a):
+			alloc_inst(a) {}
+		explicit alloc_holder(Alloc&& a):
+			alloc_inst(std::move(a)) {}
+
+		Alloc& get_alloc() { return alloc_inst; }
+		const Alloc& get_alloc() const { return alloc_inst; }
+		void swap_alloc(alloc_holder& x) {
+			Alloc tmp(std::move(alloc_inst));
+			alloc_inst = std::move(x.alloc_inst);
+			x.alloc_inst = std::move(tmp);
+		}
+
+	private:
+		Alloc alloc_inst;
 	};
 
 }
@@ -0,0 +1,274 @@
+#ifndef __LMSTL_ALLOC_TEST_H__
+#define __LMSTL_ALLOC_TEST_H__
+
+#include "test_frame.h"
+#include "alloc.h"
+#include "arena_alloc.h"
+#include "mmap_alloc.h"
+#include "deque.h"
+#include "vector.h"
+#include "list.h"
+#include "map.h"
+#include <list>
+#include <deque>
+#include <map>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+namespace lmstl {
+
+//在cache之前构造，线程退出时在cache析构之后才析构，析构时释放的块要绕过已析构的缓存
+struct __thread_alloc_holder {
+	list<int, thread_alloc> l;
+};
+
+inline bool thread_alloc_workers(int threads, int rounds) {
+	std::atomic<bool> ok(true);
+	std::vector<std::thread> ts;
+	for (int t = 0; t < threads; ++t)
+		ts.emplace_back([&ok, t, rounds] {
+			static thread_local __thread_alloc_holder holder;
+			for (int r = 0; r < rounds; ++r) {
+				list<int, thread_alloc> l;
+				map<int, int, less<int>, thread_alloc> m;
+				for (int i = 0; i < 2000; ++i) {
+					l.push_back(i);
+					m[i * 7 + t] = i;
+				}
+				long sum = 0;
+				for (auto x : l)
+					sum += x;
+				if (sum != 1999L * 2000 / 2 || m.size() != 2000)
+					ok = false;
+			}
+			for (int i = 0; i < 100; ++i)
+				holder.l.push_back(i);
+		});
+	for (size_t i = 0; i < ts.size(); ++i)
+		ts[i].join();
+	return ok;
+}
+
+//index(n)是能容纳n字节的最小class，且class大小按对齐递增
+template <class SizeClass>
+bool size_class_consistent() {
+	for (size_t n = 1; n <= SizeClass::max_bytes; ++n) {
+		size_t i = SizeClass::index(n);
+		if (i >= SizeClass::num_classes || SizeClass::size(i) < n || (i && SizeClass::size(i - 1) >= n)
+			|| SizeClass::size(i) % SizeClass::align)
+			return false;
+	}
+	return SizeClass::size(SizeClass::num_classes - 1) == SizeClass::max_bytes;
+}
+
+//reallocate到0字节时释放原来的块并返回0，小块还回空闲链表后下一次分配应取到它
+template <class Alloc>
+bool reallocate_to_zero() {
+	void* p = Alloc::allocate(24);
+	if (Alloc::reallocate(p, 24, 0) || Alloc::allocate(24) != p)
+		return false;
+	Alloc::deallocate(p, 24);
+	void* big = Alloc::allocate(1 << 16);
+	return !Alloc::reallocate(big, 1 << 16, 0) && !Alloc::reallocate(0, 0, 0);
+}
+
+//记录未归还字节数的内存资源，通过alloc_ref放进容器
+struct __counting_resource {
+	long live = 0;
+	void* allocate(size_t n) {
+		live += (long)n;
+		return malloc_alloc::allocate(n);
+	}
+	void deallocate(void* p, size_t n) {
+		live -= (long)n;
+		malloc_alloc::deallocate(p, n);
+	}
+};
+
+typedef alloc_ref<__counting_resource> counting_ref;
+
+//被移动的容器应是空的，而且还能继续插入
+inline bool moved_from_reusable(counting_ref r) {
+	deque<int, counting_ref> d(r);
+	list<int, counting_ref> l(r);
+	map<int, int, less<int>, counting_ref> m(r);
+	for (int i = 0; i < 1000; ++i) {
+		d.push_back(i);
+		l.push_back(i);
+		m[i] = i;
+	}
+	deque<int, counting_ref> d2(lmstl::move(d));
+	list<int, counting_ref> l2(lmstl::move(l));
+	map<int, int, less<int>, counting_ref> m2(lmstl::move(m));
+	if (!d.empty() || d.size() || d.begin() != d.end() || !l.empty() || !m.empty() || m.size())
+		return false;
+	if (d2.size() != 1000 || l2.size() != 1000 || m2.size() != 1000)
+		return false;
+	for (int i = 0; i < 300; ++i) {
+		d.push_back(i);
+		d.push_front(-i);
+		l.push_back(i);
+		m[3 * i] = i;
+	}
+	d.pop_front();
+	return d.size() == 599 && d.front() == -298 && d.back() == 299 && l.size() == 300 && l.back() == 299
+		&& m.size() == 300 && m[3] == 1 && m.find(4) == m.end();
+}
+
+typedef geometric_size_class<> __test_geometric;
+typedef basic_pool_alloc<false, 1, __test_geometric> geometric_pool_alloc;
+
+void alloc_test() {
+	API_TEST_START();
+	cout << "[----------------- Allocator test : thread_alloc ---------------]\n";
+	list<int, thread_alloc> ml;
+	std::list<int> sl;
+	map<int, int, less<int>, thread_alloc> mm;
+	std::map<int, int> sm;
+	for (int i = 0; i < 1000; ++i) {
+		ml.push_back(i * 3);
+		sl.push_back(i * 3);
+		mm[i * 7 % 1000] = i;
+		sm[i * 7 % 1000] = i;
+	}
+	API_COMPARE(ml, sl);
+	API_COMPARE(mm, sm);
+	API_CHECK("thread_alloc in 8 threads", thread_alloc_workers(8, 20));
+	ml.clear();
+	sl.clear();
+	API_TEST01(ml, sl, push_back, 42);
+	cout << "[------------------- Allocator test : trim --------------------]\n";
+	list<int> pl;
+	std::list<int> spl;
+	for (int i = 0; i < 200000; ++i)
+		pl.push_back(i);
+	size_t pooled = pool_alloc::pool_size;
+	pl.clear();
+	size_t released = pool_alloc::trim();
+	API_CHECK("trim releases free chunks", released > 0 && pool_alloc::pool_size < pooled);
+	for (int i = 0; i < 1000; ++i) {
+		pl.push_back(i);
+		spl.push_back(i);
+	}
+	API_COMPARE(pl, spl);
+	cout << "[------------------- Allocator test : stats -------------------]\n";
+	const size_t idx = default_size_class::index(24);
+	void* blocks[100];
+	for (int i = 0; i < 100; ++i)
+		blocks[i] = pool_alloc::allocate(24);
+	pool_stats st = pool_alloc::stats();
+	API_CHECK("stats snapshot", st.pool_size == pool_alloc::pool_size && st.chunks > 0
+		&& st.classes[idx].block_size == default_size_class::size(idx));
+	for (int i = 0; i < 100; ++i)
+		pool_alloc::deallocate(blocks[i], 24);
+	pool_stats st2 = pool_alloc::stats();
+	API_CHECK("stats free_blocks", st2.classes[idx].free_blocks == st.classes[idx].free_blocks + 100);
+#ifdef __LMSTL_ALLOC_STATS
+	API_CHECK("stats counters", st2.classes[idx].allocs >= st.classes[idx].allocs
+		&& st2.classes[idx].deallocs == st.classes[idx].deallocs + 100);
+#endif // __LMSTL_ALLOC_STATS
+	cout << "[---------------- Allocator test : size classes ----------------]\n";
+	API_CHECK("linear_size_class", size_class_consistent<linear_size_class<>>());
+	API_CHECK("geometric_size_class", size_class_consistent<__test_geometric>());
+	API_CHECK("geometric_size_class<8, 4096, 2>", (size_class_consistent<geometric_size_class<8, 4096, 2>>()));
+	vector<std::vector<char>, geometric_pool_alloc> gv;
+	std::vector<std::vector<char>> sgv;
+	for (int i = 0; i < 200; ++i) {
+		gv.push_back(std::vector<char>(i * 100, 'a'));
+		sgv.push_back(std::vector<char>(i * 100, 'a'));
+	}
+	map<int, std::vector<char>, less<int>, geometric_pool_alloc> gm;
+	bool gm_ok = true;
+	for (int i = 0; i < 200; ++i)
+		gm[i] = gv[i];
+	for (int i = 0; i < 200; ++i)
+		gm_ok = gm_ok && gm[i] == sgv[i];
+	API_CHECK("geometric pool with large blocks", gm_ok && gv.size() == sgv.size());
+	cout << "[----------------- Allocator test : reallocate -----------------]\n";
+	API_CHECK("pool_alloc reallocate to 0 bytes", reallocate_to_zero<pool_alloc>());
+	API_CHECK("thread_alloc reallocate to 0 bytes", reallocate_to_zero<thread_alloc>());
+	cout << "[------------------- Allocator test : arena -------------------]\n";
+	char buf[1 << 12];
+	monotonic_arena arena(buf, sizeof(buf));
+	{
+		arena_scope<> scope(arena);
+		vector<int, arena_alloc<0>> av;
+		deque<int, arena_alloc<0>> ad;
+		std::vector<int> sav;
+		std::deque<int> sad;
+		for (int i = 0; i < 10000; ++i) {
+			av.push_back(i);
+			sav.push_back(i);
+			ad.push_front(i);
+			sad.push_front(i);
+		}
+		API_COMPARE(av, sav);
+		API_COMPARE(ad, sad);
+		API_CHECK("arena grows past the external buffer", arena.bytes_reserved() > sizeof(buf) && arena.bytes_used() > 0);
+	}
+	API_CHECK("arena_alloc unbound outside arena_scope", arena_alloc<0>::get_arena() == 0);
+	arena.release();
+	API_CHECK("arena release", arena.bytes_used() == 0 && arena.bytes_reserved() == sizeof(buf));
+	cout << "[---------------- Allocator test : alloc_ref -----------------]\n";
+	__counting_resource res1, res2;
+	{
+		counting_ref r1(res1), r2(res2);
+		vector<int, counting_ref> rv(r1);
+		list<int, counting_ref> rl(r1);
+		deque<int, counting_ref> rd(r1);
+		map<int, int, less<int>, counting_ref> rm(r1);
+		std::vector<int> srv;
+		std::list<int> srl;
+		std::deque<int> srd;
+		std::map<int, int> srm;
+		for (int i = 0; i < 1000; ++i) {
+			rv.push_back(i);
+			srv.push_back(i);
+			rl.push_front(i);
+			srl.push_front(i);
+			rd.push_back(i);
+			srd.push_back(i);
+			rm[i * 13 % 1000] = i;
+			srm[i * 13 % 1000] = i;
+		}
+		API_COMPARE(rv, srv);
+		API_COMPARE(rl, srl);
+		API_COMPARE(rd, srd);
+		API_COMPARE(rm, srm);
+		API_CHECK("containers allocate from their resource", res1.live > 0 && res2.live == 0);
+		vector<int, counting_ref> rv2(rv);
+		list<int, counting_ref> rl2(lmstl::move(rl));
+		API_CHECK("copy and move keep the allocator", rv2.get_allocator() == r1 && rl2.get_allocator() == r1);
+		vector<int, counting_ref> rv3(r2);
+		rv3.push_back(1);
+		rv3.swap(rv2);
+		API_CHECK("swap exchanges the allocators", rv3.get_allocator() == r1 && rv2.get_allocator() == r2 && res2.live > 0);
+		API_COMPARE(rv3, srv);
+	}
+	API_CHECK("all memory returned to the resources", res1.live == 0 && res2.live == 0);
+	API_CHECK("moved-from containers stay usable", moved_from_reusable(counting_ref(res1)) && res1.live == 0);
+	cout << "[----------------- Allocator test : mmap_alloc -----------------]\n";
+	vector<int, mmap_alloc> mmv;
+	vector<int, huge_page_alloc> hv;
+	std::vector<int> smv;
+	bool huge_aligned = true;
+	for (int i = 0; i < 3000000; ++i) {
+		mmv.push_back(i);
+		hv.push_back(i);
+		smv.push_back(i);
+		if (hv.capacity() * sizeof(int) >= __MMAP_THRESHOLD)
+			huge_aligned = huge_aligned && (size_t)&hv[0] % __HUGE_PAGE_SIZE == 0;
+	}
+	API_CHECK("mmap_alloc growth", mmv.size() == smv.size() && std::equal(smv.begin(), smv.end(), mmv.begin()));
+	API_CHECK("huge_page_alloc growth", hv.size() == smv.size() && std::equal(smv.begin(), smv.end(), hv.begin()));
+#ifndef _WIN32
+	API_CHECK("huge_page_alloc keeps 2M alignment", huge_aligned);
+#endif
+	API_TEST_END();
+}
+
+}
+
+#endif // !__LMSTL_ALLOC_TEST_H__
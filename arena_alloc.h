@@ -0,0 +1,159 @@
+#ifndef __LMSTL_ARENA_ALLOC_H__
+#define __LMSTL_ARENA_ALLOC_H__
+
+#include "alloc.h"
+#include <cstddef>
+#include <stdexcept>
+
+namespace lmstl {
+
+	static const size_t __ARENA_ALIGN = alignof(std::max_align_t);
+	static const size_t __ARENA_INITIAL_BYTES = 4096;
+	static const size_t __ARENA_MAX_BLOCK = 1024 * 1024;
+
+	//单调分配区：分配只移动指针，deallocate为空操作，release时一次性归还所有内存
+	//可以给定一块外部缓冲区，用完后再向malloc_alloc申请，块大小按倍数增长
+	class monotonic_arena {
+	public:
+		explicit monotonic_arena(size_t initial = __ARENA_INITIAL_BYTES);
+		monotonic_arena(void* buf, size_t size);
+		monotonic_arena(const monotonic_arena&) = delete;
+		monotonic_arena& operator=(const monotonic_arena&) = delete;
+		~monotonic_arena() { release(); }
+
+		void* allocate(size_t n, size_t align = __ARENA_ALIGN);
+		void deallocate(void*, size_t) {}
+		void* reallocate(void*, size_t, size_t);
+		void release();
+
+		size_t bytes_used() const { return used; }
+		size_t bytes_reserved() const { return reserved; }
+
+	private:
+		struct block_header {
+			block_header* next;
+			size_t bytes;
+		};
+		static const size_t __BLOCK_HEADER = (sizeof(block_header) + __ARENA_ALIGN - 1) & ~(__ARENA_ALIGN - 1);
+
+		block_header* blocks;
+		char* cur;
+		char* end;
+		char* buf;
+		size_t buf_size;
+		size_t initial_size;
+		size_t next_size;
+		size_t used;
+		size_t reserved;
+
+		void* grow(size_t, size_t);
+	};
+
+	inline monotonic_arena::monotonic_arena(size_t initial):
+		blocks(0), cur(0), end(0), buf(0), buf_size(0),
+		initial_size(initial ? initial : __ARENA_INITIAL_BYTES), next_size(initial_size), used(0), reserved(0) {}
+
+	inline monotonic_arena::monotonic_arena(void* b, size_t size):
+		blocks(0), cur((char*)b), end((char*)b + size), buf((char*)b), buf_size(size),
+		initial_size(size > __ARENA_INITIAL_BYTES ? size : __ARENA_INITIAL_BYTES), next_size(initial_size), used(0), reserved(size) {}
+
+	inline void* monotonic_arena::allocate(size_t n, size_t align) {
+		char* p = (char*)(((size_t)cur + align - 1) & ~(align - 1));
+		if (cur && p <= end && n <= size_t(end - p)) {
+			cur = p + n;
+			used += n;
+			return p;
+		}
+		return grow(n, align);
+	}
+
+	inline void* monotonic_arena::grow(size_t n, size_t align) {
+		size_t need = n + (align > __ARENA_ALIGN ? align : 0);
+		size_t bytes = next_size;
+		while (bytes < need)
+			bytes <<= 1;
+		block_header* block = (block_header*)malloc_alloc::allocate(__BLOCK_HEADER + bytes);
+		block->next = blocks;
+		block->bytes = bytes;
+		blocks = block;
+		reserved += bytes;
+		if (next_size < __ARENA_MAX_BLOCK)
+			next_size <<= 1;
+		cur = (char*)block + __BLOCK_HEADER;
+		end = cur + bytes;
+		return allocate(n, align);
+	}
+
+	//p是最近一次分配且当前块放得下时原地伸缩，否则另外分配并复制
+	inline void* monotonic_arena::reallocate(void* p, size_t old_sz, size_t new_sz) {
+		if (p && (char*)p + old_sz == cur && (new_sz <= old_sz || new_sz - old_sz <= size_t(end - cur))) {
+			cur = (char*)p + new_sz;
+			used = used + new_sz - old_sz;
+			return p;
+		}
+		void* ret = allocate(new_sz);
+		if (p)
+			memcpy(ret, p, old_sz < new_sz ? old_sz : new_sz);
+		return ret;
+	}
+
+	//归还所有从上游申请的块，外部缓冲区重新从头使用
+	inline void monotonic_arena::release() {
+		while (blocks) {
+			block_header* next = blocks->next;
+			malloc_alloc::deallocate(blocks, __BLOCK_HEADER + blocks->bytes);
+			blocks = next;
+		}
+		cur = buf;
+		end = buf + buf_size;
+		next_size = initial_size;
+		used = 0;
+		reserved = buf_size;
+	}
+
+	//把monotonic_arena适配成容器的Alloc参数，分配转发给当前线程绑定的arena
+	//arena_scope在作用域内绑定arena；inst不同的arena_alloc各自独立绑定
+	template <int inst>
+	class arena_alloc {
+	public:
+		static void* allocate(size_t n) {
+			__THROW_RUNTIME_ERROR(!current, "arena_alloc: no arena bound to this thread");
+			return current->allocate(n);
+		}
+		static void deallocate(void*, size_t) {}
+		static void* reallocate(void* p, size_t old_sz, size_t new_sz) {
+			__THROW_RUNTIME_ERROR(!current, "arena_alloc: no arena bound to this thread");
+			return current->reallocate(p, old_sz, new_sz);
+		}
+
+		static monotonic_arena* get_arena() { return current; }
+
+	private:
+		template <int>
+		friend class arena_scope;
+		static thread_local monotonic_arena* current;
+	};
+
+	template <int inst>
+	thread_local monotonic_arena* arena_alloc<inst>::current = 0;
+
+	//作为有状态分配器放进容器：每个容器保存arena的引用，不依赖线程绑定
+	typedef alloc_ref<monotonic_arena> arena_ref;
+
+	template <int inst = 0>
+	class arena_scope {
+	public:
+		explicit arena_scope(monotonic_arena& a):
+			prev(arena_alloc<inst>::current) {
+			arena_alloc<inst>::current = &a;
+		}
+		arena_scope(const arena_scope&) = delete;
+		arena_scope& operator=(const arena_scope&) = delete;
+		~arena_scope() { arena_alloc<inst>::current = prev; }
+
+	private:
+		monotonic_arena* prev;
+	};
+
+}
+#endif // !__LMSTL_ARENA_ALLOC_H__
@@ -0,0 +1,520 @@
+#ifndef __LMSTL_BIT_VECTOR_H__
+#define __LMSTL_BIT_VECTOR_H__
+
+#include "alloc.h"
+#include "iterator.h"
+#include "exceptdef.h"
+#include "algobase.h"
+#include "vector.h"
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace lmstl {
+
+typedef uint64_t bit_word;
+static const size_t __BIT_WORD_BITS = 64;
+
+//__popcnt64要求CPU支持POPCNT指令，MSVC下改用位运算计数；gcc/clang没有开-mpopcnt时__builtin_popcountll也不会生成该指令
+inline size_t __popcount(bit_word x) {
+#ifdef _MSC_VER
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (size_t)((x * 0x0101010101010101ULL) >> 56);
+#else
+	return (size_t)__builtin_popcountll(x);
+#endif
+}
+
+//x不能为0；32位MSVC没有64位的位扫描，分两半处理
+inline size_t __lowest_bit(bit_word x) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long idx;
+	_BitScanForward64(&idx, x);
+	return (size_t)idx;
+#elif defined(_MSC_VER)
+	unsigned long idx;
+	if (_BitScanForward(&idx, (unsigned long)x))
+		return (size_t)idx;
+	_BitScanForward(&idx, (unsigned long)(x >> 32));
+	return (size_t)idx + 32;
+#else
+	return (size_t)__builtin_ctzll(x);
+#endif
+}
+
+//x不能为0
+inline size_t __highest_bit(bit_word x) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long idx;
+	_BitScanReverse64(&idx, x);
+	return (size_t)idx;
+#elif defined(_MSC_VER)
+	unsigned long idx;
+	if (_BitScanReverse(&idx, (unsigned long)(x >> 32)))
+		return (size_t)idx + 32;
+	_BitScanReverse(&idx, (unsigned long)x);
+	return (size_t)idx;
+#else
+	return (size_t)(63 - __builtin_clzll(x));
+#endif
+}
+
+struct bit_reference {
+	bit_word* p;
+	bit_word mask;
+
+	bit_reference(bit_word* x, bit_word m):
+		p(x), mask(m) {}
+
+	operator bool() const { return (*p & mask) != 0; }
+	bit_reference& operator=(bool x) {
+		if (x)
+			*p |= mask;
+		else
+			*p &= ~mask;
+		return *this;
+	}
+	bit_reference& operator=(const bit_reference& x) { return *this = bool(x); }
+	bool operator==(const bit_reference& x) const { return bool(*this) == bool(x); }
+	void flip() { *p ^= mask; }
+};
+
+inline void swap(bit_reference x, bit_reference y) {
+	bool tmp = x;
+	x = y;
+	y = tmp;
+}
+
+//位迭代器记住所在的字和字内偏移
+struct bit_iterator_base {
+	typedef random_access_iterator_tag	iterator_category;
+	typedef bool						value_type;
+	typedef ptrdiff_t					difference_type;
+
+	bit_word* p;
+	size_t offset;
+
+	bit_iterator_base(bit_word* x, size_t off):
+		p(x), offset(off) {}
+
+	void incr() {
+		if (++offset == __BIT_WORD_BITS) {
+			offset = 0;
+			++p;
+		}
+	}
+	void decr() {
+		if (offset-- == 0) {
+			offset = __BIT_WORD_BITS - 1;
+			--p;
+		}
+	}
+	void incr(difference_type n) {
+		difference_type k = n + (difference_type)offset;
+		p += k / (difference_type)__BIT_WORD_BITS;
+		k %= (difference_type)__BIT_WORD_BITS;
+		if (k < 0) {
+			k += __BIT_WORD_BITS;
+			--p;
+		}
+		offset = (size_t)k;
+	}
+
+	difference_type operator-(const bit_iterator_base& x) const {
+		return (p - x.p) * (difference_type)__BIT_WORD_BITS + (difference_type)offset - (difference_type)x.offset;
+	}
+	bool operator==(const bit_iterator_base& x) const { return p == x.p && offset == x.offset; }
+	bool operator!=(const bit_iterator_base& x) const { return !(*this == x); }
+	bool operator<(const bit_iterator_base& x) const { return p < x.p || (p == x.p && offset < x.offset); }
+	bool operator>(const bit_iterator_base& x) const { return x < *this; }
+	bool operator<=(const bit_iterator_base& x) const { return !(x < *this); }
+	bool operator>=(const bit_iterator_base& x) const { return !(*this < x); }
+};
+
+struct bit_iterator : public bit_iterator_base {
+	typedef bit_reference	reference;
+	typedef bit_reference*	pointer;
+	typedef bit_iterator	iterator;
+
+	bit_iterator():
+		bit_iterator_base(0, 0) {}
+	bit_iterator(bit_word* x, size_t off):
+		bit_iterator_base(x, off) {}
+
+	reference operator*() const { return reference(p, bit_word(1) << offset); }
+	reference operator[](difference_type n) const { return *(*this + n); }
+	iterator& operator++() { incr(); return *this; }
+	iterator operator++(int) { iterator tmp = *this; incr(); return tmp; }
+	iterator& operator--() { decr(); return *this; }
+	iterator operator--(int) { iterator tmp = *this; decr(); return tmp; }
+	iterator& operator+=(difference_type n) { incr(n); return *this; }
+	iterator& operator-=(difference_type n) { incr(-n); return *this; }
+	iterator operator+(difference_type n) const { iterator tmp = *this; return tmp += n; }
+	iterator operator-(difference_type n) const { iterator tmp = *this; return tmp -= n; }
+	using bit_iterator_base::operator-;
+};
+
+struct bit_const_iterator : public bit_iterator_base {
+	typedef bool				reference;
+	typedef const bool*			pointer;
+	typedef bit_const_iterator	iterator;
+
+	bit_const_iterator():
+		bit_iterator_base(0, 0) {}
+	bit_const_iterator(const bit_word* x, size_t off):
+		bit_iterator_base(const_cast<bit_word*>(x), off) {}
+	bit_const_iterator(const bit_iterator& x):
+		bit_iterator_base(x.p, x.offset) {}
+
+	reference operator*() const { return ((*p >> offset) & 1) != 0; }
+	reference operator[](difference_type n) const { return *(*this + n); }
+	iterator& operator++() { incr(); return *this; }
+	iterator operator++(int) { iterator tmp = *this; incr(); return tmp; }
+	iterator& operator--() { decr(); return *this; }
+	iterator operator--(int) { iterator tmp = *this; decr(); return tmp; }
+	iterator& operator+=(difference_type n) { incr(n); return *this; }
+	iterator& operator-=(difference_type n) { incr(-n); return *this; }
+	iterator operator+(difference_type n) const { iterator tmp = *this; return tmp += n; }
+	iterator operator-(difference_type n) const { iterator tmp = *this; return tmp -= n; }
+	using bit_iterator_base::operator-;
+};
+
+//每个bool只占一位，按64位字存放；count、find_first/find_next、rank和按位运算都是一次处理一个字
+//最后一个字中超出size()的位始终为0
+template <typename Alloc = alloc, typename Growth = default_growth>
+class basic_bit_vector : private alloc_holder<Alloc> {
+public:
+	typedef bool				value_type;
+	typedef bit_reference		reference;
+	typedef bool				const_reference;
+	typedef bit_iterator		iterator;
+	typedef bit_const_iterator	const_iterator;
+	typedef reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef reverse_iterator<iterator> reverse_iterator;
+	typedef ptrdiff_t			difference_type;
+	typedef size_t				size_type;
+	typedef bit_word			word_type;
+	typedef Alloc				allocator_type;
+
+	static const size_type npos = size_type(-1);
+
+public:
+	basic_bit_vector():
+		start(0), nbits(0), nwords(0) {}
+	explicit basic_bit_vector(const Alloc& a):
+		alloc_base(a), start(0), nbits(0), nwords(0) {}
+	explicit basic_bit_vector(size_type n, bool val = false, const Alloc& a = Alloc()):
+		basic_bit_vector(a) {
+		resize(n, val);
+	}
+	basic_bit_vector(const basic_bit_vector& x):
+		basic_bit_vector(x.get_alloc()) {
+		reserve(x.nbits);
+		if (x.nbits)
+			memcpy(start, x.start, words_for(x.nbits) * sizeof(word_type));
+		nbits = x.nbits;
+	}
+	basic_bit_vector(basic_bit_vector&& x) noexcept :
+		alloc_base(lmstl::move(x.get_alloc())), start(x.start), nbits(x.nbits), nwords(x.nwords) {
+		x.start = 0;
+		x.nbits = x.nwords = 0;
+	}
+
+	~basic_bit_vector() {
+		if (nwords)
+			data_allocator::deallocate(this->get_alloc(), start, nwords);
+	}
+
+	basic_bit_vector& operator=(const basic_bit_vector& x) {
+		if (this != &x) {
+			basic_bit_vector tmp(x);
+			swap(tmp);
+		}
+		return *this;
+	}
+	basic_bit_vector& operator=(basic_bit_vector&& x) noexcept {
+		if (this != &x) {
+			basic_bit_vector tmp(lmstl::move(x));
+			swap(tmp);
+		}
+		return *this;
+	}
+
+	allocator_type get_allocator() const { return this->get_alloc(); }
+
+protected:
+	typedef alloc_holder<Alloc> alloc_base;
+	typedef simple_alloc<word_type, Alloc> data_allocator;
+	word_type* start;
+	size_type nbits;
+	size_type nwords;
+
+	static size_type words_for(size_type n) { return (n + __BIT_WORD_BITS - 1) / __BIT_WORD_BITS; }
+	static word_type bit_mask(size_type n) { return word_type(1) << (n % __BIT_WORD_BITS); }
+
+	//把最后一个字中超出size()的位清零
+	void trim() {
+		if (nbits % __BIT_WORD_BITS)
+			start[nbits / __BIT_WORD_BITS] &= bit_mask(nbits) - 1;
+	}
+
+	void reallocate_storage(size_type words) {
+		word_type* new_start = data_allocator::allocate(this->get_alloc(), words);
+		const size_type used = words_for(nbits);
+		if (used)
+			memcpy(new_start, start, used * sizeof(word_type));
+		if (nwords)
+			data_allocator::deallocate(this->get_alloc(), start, nwords);
+		start = new_start;
+		nwords = words;
+	}
+
+public:
+
+	iterator begin() noexcept { return iterator(start, 0); }
+	const_iterator begin() const noexcept { return const_iterator(start, 0); }
+	const_iterator cbegin() const noexcept { return const_iterator(start, 0); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+	iterator end() noexcept { return iterator(start + nbits / __BIT_WORD_BITS, nbits % __BIT_WORD_BITS); }
+	const_iterator end() const noexcept { return const_iterator(start + nbits / __BIT_WORD_BITS, nbits % __BIT_WORD_BITS); }
+	const_iterator cend() const noexcept { return end(); }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+	size_type size() const noexcept { return nbits; }
+	size_type capacity() const noexcept { return nwords * __BIT_WORD_BITS; }
+	bool empty() const noexcept { return nbits == 0; }
+
+	//底层的字数组，共words()个字
+	word_type* data() noexcept { return start; }
+	const word_type* data() const noexcept { return start; }
+	size_type words() const noexcept { return words_for(nbits); }
+
+	void swap(basic_bit_vector& x) {
+		lmstl::swap(start, x.start);
+		lmstl::swap(nbits, x.nbits);
+		lmstl::swap(nwords, x.nwords);
+		this->swap_alloc(x);
+	}
+
+	reference operator[](size_type n) {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= nbits, "Index out of range");
+		return reference(start + n / __BIT_WORD_BITS, bit_mask(n));
+	}
+	const_reference operator[](size_type n) const {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= nbits, "Index out of range");
+		return test(n);
+	}
+
+	reference at(size_type n) {
+		__THROW_OUT_OF_RANGE_ERROR(n >= nbits, "Index out of range");
+		return reference(start + n / __BIT_WORD_BITS, bit_mask(n));
+	}
+	const_reference at(size_type n) const {
+		__THROW_OUT_OF_RANGE_ERROR(n >= nbits, "Index out of range");
+		return test(n);
+	}
+
+	reference front() noexcept { return (*this)[0]; }
+	const_reference front() const noexcept { return test(0); }
+	reference back() noexcept { return (*this)[nbits - 1]; }
+	const_reference back() const noexcept { return test(nbits - 1); }
+
+	bool test(size_type n) const noexcept { return (start[n / __BIT_WORD_BITS] & bit_mask(n)) != 0; }
+	void set(size_type n, bool val = true) noexcept {
+		if (val)
+			start[n / __BIT_WORD_BITS] |= bit_mask(n);
+		else
+			start[n / __BIT_WORD_BITS] &= ~bit_mask(n);
+	}
+	void reset(size_type n) noexcept { start[n / __BIT_WORD_BITS] &= ~bit_mask(n); }
+	void flip(size_type n) noexcept { start[n / __BIT_WORD_BITS] ^= bit_mask(n); }
+
+	void set() noexcept {
+		if (nbits) {
+			memset(start, 0xff, words() * sizeof(word_type));
+			trim();
+		}
+	}
+	void reset() noexcept {
+		if (nbits)
+			memset(start, 0, words() * sizeof(word_type));
+	}
+	void flip() noexcept {
+		for (size_type i = 0, w = words(); i != w; ++i)
+			start[i] = ~start[i];
+		trim();
+	}
+
+	void push_back(bool val) {
+		if (nbits == capacity())
+			reallocate_storage(Growth::next(nwords, words_for(nbits + 1), sizeof(word_type)));
+		if (nbits % __BIT_WORD_BITS == 0)
+			start[nbits / __BIT_WORD_BITS] = 0;
+		++nbits;
+		set(nbits - 1, val);
+	}
+
+	void pop_back() {
+		__THROW_RUNTIME_ERROR(empty(), "pop_back on empty bit_vector");
+		--nbits;
+		reset(nbits);
+	}
+
+	void resize(size_type n, bool val = false) {
+		if (n <= nbits) {
+			nbits = n;
+			trim();
+			return;
+		}
+		reserve(n);
+		const size_type old_words = words_for(nbits);
+		const size_type new_words = words_for(n);
+		if (new_words > old_words)
+			memset(start + old_words, val ? 0xff : 0, (new_words - old_words) * sizeof(word_type));
+		if (val && nbits % __BIT_WORD_BITS)
+			start[nbits / __BIT_WORD_BITS] |= ~(bit_mask(nbits) - 1);
+		nbits = n;
+		trim();
+	}
+
+	void reserve(size_type n) {
+		if (words_for(n) > nwords)
+			reallocate_storage(words_for(n));
+	}
+
+	void shrink_to_fit() {
+		const size_type w = words_for(nbits);
+		if (w == nwords)
+			return;
+		if (!w) {
+			data_allocator::deallocate(this->get_alloc(), start, nwords);
+			start = 0;
+			nwords = 0;
+			return;
+		}
+		reallocate_storage(w);
+	}
+
+	void clear() noexcept { nbits = 0; }
+
+	size_type count() const noexcept {
+		size_type ret = 0;
+		for (size_type i = 0, w = words(); i != w; ++i)
+			ret += __popcount(start[i]);
+		return ret;
+	}
+	bool any() const noexcept {
+		for (size_type i = 0, w = words(); i != w; ++i)
+			if (start[i])
+				return true;
+		return false;
+	}
+	bool none() const noexcept { return !any(); }
+	bool all() const noexcept { return count() == nbits; }
+
+	//[0, pos)中置位的个数
+	size_type rank(size_type pos) const noexcept {
+		const size_type full = pos / __BIT_WORD_BITS;
+		size_type ret = 0;
+		for (size_type i = 0; i != full; ++i)
+			ret += __popcount(start[i]);
+		if (pos % __BIT_WORD_BITS)
+			ret += __popcount(start[full] & (bit_mask(pos) - 1));
+		return ret;
+	}
+
+	//第一个置位的下标，没有时返回npos
+	size_type find_first() const noexcept { return find_from(0); }
+
+	//pos之后第一个置位的下标，没有时返回npos
+	size_type find_next(size_type pos) const noexcept {
+		if (pos + 1 >= nbits)
+			return npos;
+		return find_from(pos + 1);
+	}
+
+	basic_bit_vector& operator&=(const basic_bit_vector& x) {
+		__THROW_RUNTIME_ERROR(nbits != x.nbits, "bit_vector size mismatch");
+		for (size_type i = 0, w = words(); i != w; ++i)
+			start[i] &= x.start[i];
+		return *this;
+	}
+	basic_bit_vector& operator|=(const basic_bit_vector& x) {
+		__THROW_RUNTIME_ERROR(nbits != x.nbits, "bit_vector size mismatch");
+		for (size_type i = 0, w = words(); i != w; ++i)
+			start[i] |= x.start[i];
+		return *this;
+	}
+	basic_bit_vector& operator^=(const basic_bit_vector& x) {
+		__THROW_RUNTIME_ERROR(nbits != x.nbits, "bit_vector size mismatch");
+		for (size_type i = 0, w = words(); i != w; ++i)
+			start[i] ^= x.start[i];
+		return *this;
+	}
+	basic_bit_vector operator~() const {
+		basic_bit_vector ret(*this);
+		ret.flip();
+		return ret;
+	}
+
+	bool operator==(const basic_bit_vector& x) const {
+		return nbits == x.nbits && (!nbits || memcmp(start, x.start, words() * sizeof(word_type)) == 0);
+	}
+	bool operator!=(const basic_bit_vector& x) const { return !(*this == x); }
+
+private:
+	size_type find_from(size_type pos) const noexcept {
+		size_type i = pos / __BIT_WORD_BITS;
+		const size_type w = words();
+		if (i >= w)
+			return npos;
+		word_type cur = start[i] & ~(bit_mask(pos) - 1);
+		while (!cur) {
+			if (++i == w)
+				return npos;
+			cur = start[i];
+		}
+		return i * __BIT_WORD_BITS + __lowest_bit(cur);
+	}
+};
+
+typedef basic_bit_vector<> bit_vector;
+
+template <typename Alloc, typename Growth>
+inline basic_bit_vector<Alloc, Growth> operator&(const basic_bit_vector<Alloc, Growth>& x, const basic_bit_vector<Alloc, Growth>& y) {
+	basic_bit_vector<Alloc, Growth> ret(x);
+	ret &= y;
+	return ret;
+}
+
+template <typename Alloc, typename Growth>
+inline basic_bit_vector<Alloc, Growth> operator|(const basic_bit_vector<Alloc, Growth>& x, const basic_bit_vector<Alloc, Growth>& y) {
+	basic_bit_vector<Alloc, Growth> ret(x);
+	ret |= y;
+	return ret;
+}
+
+template <typename Alloc, typename Growth>
+inline basic_bit_vector<Alloc, Growth> operator^(const basic_bit_vector<Alloc, Growth>& x, const basic_bit_vector<Alloc, Growth>& y) {
+	basic_bit_vector<Alloc, Growth> ret(x);
+	ret ^= y;
+	return ret;
+}
+
+template <typename Alloc, typename Growth>
+inline void swap(basic_bit_vector<Alloc, Growth>& x, basic_bit_vector<Alloc, Growth>& y) {
+	x.swap(y);
+}
+
+}
+#endif // !__LMSTL_BIT_VECTOR_H__
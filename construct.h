@@ -18,6 +18,12 @@ inline void construct(T1* p, T2&& value) {
 	new(p) T1(lmstl::forward<T2>(value));
 }
 
+//ûвʱԭصöӦĹ캯emplaceϵʹ
+template <typename T1, typename... Args>
+inline void construct(T1* p, Args&&... args) {
+	new(p) T1(lmstl::forward<Args>(args)...);
+}
+
 template <typename T>
 inline void destroy(T* pointer) {
 	pointer->~T();//ʽõıʾκαƣ֪Ƿ
@@ -13,8 +13,18 @@ namespace lmstl {
 
 const size_t Init_Map_Size = 8;
 
-inline size_t __deque_buf_size(size_t n, size_t sz) {
-	return n ? n : (sz < 512 ? size_t(512 / sz) : size_t(1));
+//Buff_sizeΪ0ʱÿֽڰͷļ֮ǰ޸
+#ifndef __LMSTL_DEQUE_BUF_BYTES
+#define __LMSTL_DEQUE_BUF_BYTES 512
+#endif
+
+//pop_front/pop_back/eraseͷŵĻdeque´Ҫ»ʱֱȡãôΪ0ʱ
+#ifndef __LMSTL_DEQUE_SPARE_BLOCKS
+#define __LMSTL_DEQUE_SPARE_BLOCKS 2
+#endif
+
+constexpr size_t __deque_buf_size(size_t n, size_t sz) {
+	return n ? n : (sz < __LMSTL_DEQUE_BUF_BYTES ? size_t(__LMSTL_DEQUE_BUF_BYTES / sz) : size_t(1));
 }
 
 template <typename T, typename Ref, typename Ptr, size_t Buff_size>	//RefPtrΪconst_iteratorɣ
@@ -131,8 +141,34 @@ struct deque_iterator : public iterator<random_access_iterator_tag, T> {
 
 };
 
+//dequeÿһΣ㷨ʡȥÿһĻ
+template <typename T, typename Ref, typename Ptr, size_t Buff_size>
+struct segmented_iterator_traits<deque_iterator<T, Ref, Ptr, Buff_size>> {
+	static const bool is_segmented = true;
+	typedef deque_iterator<T, Ref, Ptr, Buff_size> iterator;
+	typedef T** segment_iterator;
+	typedef Ptr local_iterator;
+
+	static segment_iterator segment(const iterator& it) { return it.node; }
+	static local_iterator local(const iterator& it) { return it.cur; }
+	static local_iterator begin(segment_iterator s) { return *s; }
+	static local_iterator end(segment_iterator s) { return *s + iterator::buffer_size(); }
+
+	//pڶβʱoperator+=һƵһεĿͷ
+	static iterator compose(segment_iterator s, local_iterator p) {
+		iterator it;
+		it.set_node(s);
+		it.cur = const_cast<T*>(p);
+		if (it.cur == it.last) {
+			it.set_node(s + 1);
+			it.cur = it.first;
+		}
+		return it;
+	}
+};
+
 template <typename T, typename Alloc = alloc, size_t Buff_size = 0>
-class deque {
+class deque : private alloc_holder<Alloc> {
 public:
 	typedef T			value_type;
 	typedef T*			pointer;
@@ -146,14 +182,18 @@ public:
 	typedef deque_iterator<T, const T&, const T*, Buff_size> const_iterator;
 	typedef reverse_iterator<const_iterator> const_reverse_iterator;
 	typedef reverse_iterator<iterator> reverse_iterator;
+	typedef Alloc		allocator_type;
 
 protected:
 	typedef pointer* map_pointer;
+	typedef alloc_holder<Alloc> alloc_base;
 
 	iterator start;
 	iterator finish;
 	map_pointer map;
 	size_type map_size;
+	pointer spare[__LMSTL_DEQUE_SPARE_BLOCKS ? __LMSTL_DEQUE_SPARE_BLOCKS : 1] = {};
+	size_type spare_count = 0;
 
 public:
 	iterator begin() noexcept { return start; }
@@ -180,22 +220,40 @@ public:
 	bool empty() const { return finish == start; }
 
 protected:
-	typedef simple_alloc<value_type> data_allocator;
-	typedef simple_alloc<pointer> map_allocator;
+	typedef simple_alloc<value_type, Alloc> data_allocator;
+	typedef simple_alloc<pointer, Alloc> map_allocator;
 
 	static size_type buffer_size() { return __deque_buf_size(Buff_size, sizeof(T)); }
 
+	pointer allocate_block() {
+		if (spare_count)
+			return spare[--spare_count];
+		return data_allocator::allocate(this->get_alloc(), buffer_size());
+	}
+
+	void deallocate_block(pointer p) {
+		if (spare_count < __LMSTL_DEQUE_SPARE_BLOCKS)
+			spare[spare_count++] = p;
+		else
+			data_allocator::deallocate(this->get_alloc(), p, buffer_size());
+	}
+
+	void release_spare_blocks() {
+		while (spare_count)
+			data_allocator::deallocate(this->get_alloc(), spare[--spare_count], buffer_size());
+	}
+
 	void create_map_and_nodes(size_type num_elements) {
 		size_type num_nodes = num_elements / buffer_size() + 1;
 		map_size = lmstl::max(Init_Map_Size, num_nodes + 2);
-		map = map_allocator::allocate(map_size);
+		map = map_allocator::allocate(this->get_alloc(), map_size);
 
 		map_pointer nstart = map + ((map_size - num_nodes) >> 1);
 		map_pointer nfinish = nstart + num_nodes - 1;
 		map_pointer cur_node;
 
 		for (cur_node = nstart; cur_node <= nfinish; ++cur_node)
-			*cur_node = data_allocator::allocate(buffer_size());
+			*cur_node = allocate_block();
 
 		start.set_node(nstart);
 		finish.set_node(nfinish);
@@ -207,8 +265,8 @@ protected:
 		create_map_and_nodes(n);
 		map_pointer cur_node;
 		for (cur_node = start.node; cur_node < finish.node; ++cur_node)
-			uninitialized_fill(*cur_node, *cur_node + buffer_size(), val);
-		uninitialized_fill(finish.first, finish.cur, val);
+			lmstl::uninitialized_fill(*cur_node, *cur_node + buffer_size(), val);
+		lmstl::uninitialized_fill(finish.first, finish.cur, val);
 	}
 
 	void reallocate_map(size_type nodes_to_add, bool add_at_front) {
@@ -225,10 +283,10 @@ protected:
 		}
 		else {
 			size_type new_map_size = map_size + lmstl::max(map_size, nodes_to_add) + 2;
-			map_pointer new_map = map_allocator::allocate(new_map_size);
+			map_pointer new_map = map_allocator::allocate(this->get_alloc(), new_map_size);
 			new_nstart = new_map + ((new_map_size - new_num_nodes)>>1) + (add_at_front ? nodes_to_add : 0);
 			lmstl::copy(start.node, finish.node + 1, new_nstart);
-			map_allocator::deallocate(map, map_size);
+			map_allocator::deallocate(this->get_alloc(), map, map_size);
 			map = new_map;
 			map_size = new_map_size;
 		}
@@ -249,7 +307,7 @@ protected:
 	void push_back_aux(const value_type& val) {
 		value_type val_copy = val;
 		reserve_map_back();
-		*(finish.node + 1) = data_allocator::allocate(buffer_size());
+		*(finish.node + 1) = allocate_block();
 		construct(finish.cur, val_copy);
 		finish.set_node(finish.node + 1);
 		finish.cur = finish.first;
@@ -258,14 +316,14 @@ protected:
 	void push_front_aux(const value_type& val) {
 		value_type val_copy = val;
 		reserve_map_front();
-		*(start.node - 1) = data_allocator::allocate(buffer_size());
+		*(start.node - 1) = allocate_block();
 		start.set_node(start.node - 1);
 		start.cur = start.last - 1;
 		construct(start.cur, val_copy);
 	}
 
 	void pop_back_aux() {
-		data_allocator::deallocate(finish.first, buffer_size());
+		deallocate_block(finish.first);
 		finish.set_node(finish.node - 1);
 		finish.cur = finish.last - 1;
 		destroy(finish.cur);
@@ -273,7 +331,7 @@ protected:
 
 	void pop_front_aux() {
 		destroy(start.cur);
-		data_allocator::deallocate(start.first, buffer_size());
+		deallocate_block(start.first);
 		start.set_node(start.node + 1);
 		start.cur = start.first;
 	}
@@ -308,7 +366,8 @@ protected:
 	}
 
 public:
-	deque(size_type n, const value_type& val) {
+	deque(size_type n, const value_type& val, const Alloc& a = Alloc()):
+		alloc_base(a) {
 		fill_initialize(n, val);
 	}
 
@@ -316,6 +375,64 @@ public:
 		create_map_and_nodes(0);
 	}
 
+	explicit deque(const Alloc& a):
+		alloc_base(a) {
+		create_map_and_nodes(0);
+	}
+
+	deque(const deque& x):
+		alloc_base(x.get_alloc()) {
+		create_map_and_nodes(x.size());
+		lmstl::uninitialized_copy(x.begin(), x.end(), start);
+	}
+
+	//ȽһյпٽƶdequeǿԼʹõĿ
+	deque(deque&& x):
+		alloc_base(x.get_alloc()) {
+		create_map_and_nodes(0);
+		swap(x);
+	}
+
+	~deque() {
+		if (map) {
+			clear();
+			data_allocator::deallocate(this->get_alloc(), start.first, buffer_size());
+			map_allocator::deallocate(this->get_alloc(), map, map_size);
+		}
+		release_spare_blocks();
+	}
+
+	//ƸֵԼķƶֵͬһ𽻻
+	deque& operator=(const deque& x) {
+		if (this != &x) {
+			if (map)
+				clear();
+			else
+				create_map_and_nodes(0);
+			for (const_iterator it = x.begin(); it != x.end(); ++it)
+				push_back(*it);
+		}
+		return *this;
+	}
+
+	deque& operator=(deque&& x) noexcept {
+		swap(x);
+		return *this;
+	}
+
+	void swap(deque& x) {
+		lmstl::swap(start, x.start);
+		lmstl::swap(finish, x.finish);
+		lmstl::swap(map, x.map);
+		lmstl::swap(map_size, x.map_size);
+		for (size_type i = 0; i != __LMSTL_DEQUE_SPARE_BLOCKS; ++i)
+			lmstl::swap(spare[i], x.spare[i]);
+		lmstl::swap(spare_count, x.spare_count);
+		this->swap_alloc(x);
+	}
+
+	allocator_type get_allocator() const { return this->get_alloc(); }
+
 	void push_back(const value_type& val) {
 		if (finish.cur != finish.last - 1) {
 			construct(finish.cur, val);
@@ -353,19 +470,24 @@ public:
 
 	void clear() {
 		for (map_pointer node = start.node + 1; node < finish.node; ++node) {
-			destroy(*node, *node + buffer_size());
-			data_allocator::deallocate(*node, buffer_size());
+			lmstl::destroy(*node, *node + buffer_size());
+			deallocate_block(*node);
 		}
 		if (start.node != finish.node) {
-			destroy(start.first, start.last);
-			destroy(finish.first, finish.cur);
-			data_allocator::deallocate(*finish.node, buffer_size());
+			lmstl::destroy(start.cur, start.last);
+			lmstl::destroy(finish.first, finish.cur);
+			deallocate_block(*finish.node);
 		}
 		else
-			destroy(start.cur, start.last);
+			lmstl::destroy(start.cur, finish.cur);
 		finish = start;
 	}
 
+	//ѻĿл
+	void shrink_to_fit() {
+		release_spare_blocks();
+	}
+
 	iterator erase(iterator pos) {
 		difference_type index = pos - start;
 		iterator next = pos;
@@ -391,17 +513,17 @@ public:
 		if (elems_before < ((size() - n) >> 1)) {
 			lmstl::copy_backward(start, beg, end);
 			iterator new_start = start + n;
-			destroy(start, new_start);
+			lmstl::destroy(start, new_start);
 			for (map_pointer p = start.node; p < new_start.node; p++)
-				data_allocator::deallocate(*p, buffer_size());
+				deallocate_block(*p);
 			start = new_start;
 		}
 		else {
 			lmstl::copy(end, finish, beg);
 			iterator new_finish = finish - n;
-			destroy(new_finish, finish);
+			lmstl::destroy(new_finish, finish);
 			for (map_pointer p = new_finish.node + 1; p <= finish.node; p++)
-				data_allocator::deallocate(*p, buffer_size());
+				deallocate_block(*p);
 			finish = new_finish;
 		}
 		return start + elems_before;
@@ -435,6 +557,10 @@ public:
 
 };
 
+//ֽԪظָС
+template <typename T, size_t BlockBytes, typename Alloc = alloc>
+using block_deque = deque<T, Alloc, (BlockBytes < sizeof(T) ? 1 : BlockBytes / sizeof(T))>;
+
 template <typename T, typename Alloc = alloc, size_t Buff_size>
 inline bool operator==(const deque<T, Alloc, Buff_size>& lhs, const deque<T, Alloc, Buff_size>& rhs) {
 	return (lhs.start == rhs.start && lhs.finish == rhs.finish && lhs.map == rhs.map);
@@ -0,0 +1,285 @@
+#ifndef __LMSTL_DEQUE_TEST_H__
+#define __LMSTL_DEQUE_TEST_H__
+
+#include "test_frame.h"
+#include "deque.h"
+#include "vector.h"
+#include "algo.h"
+#include "numeric.h"
+#include <deque>
+#include <vector>
+#include <string>
+#include <numeric>
+#include <algorithm>
+#include <cstdlib>
+#include <time.h>
+
+namespace lmstl {
+
+//记录分配次数和未归还字节数，用来观察deque缓冲区的复用
+struct __block_counter {
+	long allocs = 0;
+	long live = 0;
+	void* allocate(size_t n) {
+		++allocs;
+		live += (long)n;
+		return malloc_alloc::allocate(n);
+	}
+	void deallocate(void* p, size_t n) {
+		live -= (long)n;
+		malloc_alloc::deallocate(p, n);
+	}
+};
+
+typedef alloc_ref<__block_counter> block_ref;
+
+//队列长度不变时反复push_back/pop_front，释放的缓冲区被下一次取用，不再向分配器要内存
+inline bool deque_recycles_blocks() {
+	__block_counter res;
+	{
+		deque<int, block_ref> d((block_ref(res)));
+		for (int i = 0; i < 10000; ++i)
+			d.push_back(i);
+		//窗口整体滑过很多缓冲区，也让map长到足够大
+		for (int i = 0; i < 100000; ++i) {
+			d.push_back(i);
+			d.pop_front();
+		}
+		for (int i = 0; i < 100000; ++i) {
+			d.push_front(i);
+			d.pop_back();
+		}
+		const long before = res.allocs;
+		for (int i = 0; i < 100000; ++i) {
+			d.push_back(i);
+			d.pop_front();
+		}
+		for (int i = 0; i < 100000; ++i) {
+			d.push_front(i);
+			d.pop_back();
+		}
+		if (__LMSTL_DEQUE_SPARE_BLOCKS && res.allocs != before)
+			return false;
+		deque<int, block_ref> d2(lmstl::move(d));
+		deque<int, block_ref> d3((block_ref(res)));
+		d3.swap(d2);
+		for (int i = 0; i < 1000; ++i)
+			d3.pop_front();
+		d3.shrink_to_fit();
+		if (d3.size() != 9000 || d3.front() != 100000 - 1001 || d3.back() != 100000 - 10000)
+			return false;
+	}
+	return res.live == 0;
+}
+
+template <typename Deque, typename StdDeque>
+bool deque_same(const Deque& d, const StdDeque& sd) {
+	if (d.size() != sd.size())
+		return false;
+	for (size_t i = 0; i < sd.size(); ++i)
+		if (d[i] != sd[i])
+			return false;
+	return true;
+}
+
+inline long __seg_hash(long x, int y) { return (x * 31 + y) % 1000003; }
+inline bool __seg_pred(int x) { return x % 97 == 13; }
+
+//n个元素的deque，前后两头都push过，在各种子区间[a, b)上逐个比较分段算法和std的结果
+inline bool segmented_algo_ranges(int n) {
+	deque<int> d;
+	std::deque<int> sd;
+	for (int i = 0; i < n; ++i) {
+		if (i % 3) {
+			d.push_back(i);
+			sd.push_back(i);
+		}
+		else {
+			d.push_front(i);
+			sd.push_front(i);
+		}
+	}
+	for (int a = 0; a <= n; a += n / 7 + 1)
+		for (int b = a; b <= n; b += n / 5 + 1) {
+			std::vector<int> out(b - a + 1, -1);
+			if (lmstl::copy(d.begin() + a, d.begin() + b, out.data()) != out.data() + (b - a)
+				|| !std::equal(sd.begin() + a, sd.begin() + b, out.begin()))
+				return false;
+			const long sum = lmstl::accumulate(d.begin() + a, d.begin() + b, 0L);
+			if (sum != std::accumulate(sd.begin() + a, sd.begin() + b, 0L)
+				|| lmstl::accumulate(d.begin() + a, d.begin() + b, 1L, __seg_hash) != std::accumulate(sd.begin() + a, sd.begin() + b, 1L, __seg_hash))
+				return false;
+			for (int k = a; k < b; k += (b - a) / 3 + 1)
+				if (lmstl::find(d.begin() + a, d.begin() + b, sd[k]) - d.begin() != std::find(sd.begin() + a, sd.begin() + b, sd[k]) - sd.begin()
+					|| (long)lmstl::count(d.begin() + a, d.begin() + b, sd[k]) != (long)std::count(sd.begin() + a, sd.begin() + b, sd[k]))
+					return false;
+			if (lmstl::find(d.begin() + a, d.begin() + b, -5) != d.begin() + b
+				|| lmstl::find_if(d.begin() + a, d.begin() + b, __seg_pred) - d.begin() != std::find_if(sd.begin() + a, sd.begin() + b, __seg_pred) - sd.begin()
+				|| (long)lmstl::count_if(d.begin() + a, d.begin() + b, __seg_pred) != (long)std::count_if(sd.begin() + a, sd.begin() + b, __seg_pred))
+				return false;
+			long each = 0;
+			lmstl::for_each(d.begin() + a, d.begin() + b, [&each](int x) { each += x; });
+			if (each != sum)
+				return false;
+			lmstl::fill(d.begin() + a, d.begin() + b, 42);
+			std::fill(sd.begin() + a, sd.begin() + b, 42);
+			if (lmstl::fill_n(d.begin() + a, (b - a) / 2, 7) != d.begin() + a + (b - a) / 2)
+				return false;
+			std::fill_n(sd.begin() + a, (b - a) / 2, 7);
+			if (!deque_same(d, sd))
+				return false;
+			for (int i = 0; i < n; ++i)
+				d[i] = sd[i] = i;
+			//同一个deque里往前搬，以及搬到另一个deque的对应位置
+			const int shift = (n - b) / 2;
+			lmstl::copy(d.begin() + a + shift, d.begin() + b + shift, d.begin() + a);
+			std::copy(sd.begin() + a + shift, sd.begin() + b + shift, sd.begin() + a);
+			deque<int> d2(n, 0);
+			std::deque<int> sd2(n, 0);
+			lmstl::copy(d.begin() + a, d.begin() + b, d2.begin() + (n - b));
+			std::copy(sd.begin() + a, sd.begin() + b, sd2.begin() + (n - b));
+			if (!deque_same(d, sd) || !deque_same(d2, sd2))
+				return false;
+		}
+	return true;
+}
+
+//从连续内存复制到deque，起点和长度都落在缓冲区边界附近
+inline bool copy_to_segmented_boundaries() {
+	const int block = (int)__deque_buf_size(0, sizeof(int));
+	const int offsets[] = { 0, 1, block - 1, block, block + 1, 2 * block - 1, 2 * block };
+	const int lengths[] = { 0, 1, block - 1, block, block + 1, 3 * block + 5 };
+	std::vector<int> src(4 * block);
+	for (size_t i = 0; i < src.size(); ++i)
+		src[i] = (int)i * 7 + 1;
+	for (int off : offsets)
+		for (int len : lengths) {
+			deque<int> d(off + len + block, -1);
+			std::deque<int> sd(off + len + block, -1);
+			if (lmstl::copy(src.data(), src.data() + len, d.begin() + off) != d.begin() + off + len)
+				return false;
+			std::copy(src.begin(), src.begin() + len, sd.begin() + off);
+			if (!deque_same(d, sd))
+				return false;
+		}
+	deque<std::string> ds(300, std::string("-"));
+	std::deque<std::string> sds(300, std::string("-"));
+	std::vector<std::string> strs;
+	for (int i = 0; i < 200; ++i)
+		strs.push_back(std::to_string(i));
+	lmstl::copy(strs.data(), strs.data() + strs.size(), ds.begin() + 50);
+	std::copy(strs.begin(), strs.end(), sds.begin() + 50);
+	return deque_same(ds, sds);
+}
+
+//numeric.h的adjacent_difference、partial_sum和带二元操作的accumulate与std一致
+inline bool numeric_matches() {
+	int v[10], mout[10], sout[10];
+	for (int i = 0; i < 10; ++i)
+		v[i] = (i + 1) * (i + 1);
+	if (lmstl::adjacent_difference(v, v + 10, mout) != mout + 10)
+		return false;
+	std::adjacent_difference(v, v + 10, sout);
+	if (!std::equal(mout, mout + 10, sout))
+		return false;
+	if (lmstl::partial_sum(v, v + 10, mout) != mout + 10)
+		return false;
+	std::partial_sum(v, v + 10, sout);
+	if (!std::equal(mout, mout + 10, sout))
+		return false;
+	if (lmstl::partial_sum(v, v, mout) != mout || lmstl::adjacent_difference(v, v, mout) != mout)
+		return false;
+	return lmstl::accumulate(v, v + 10, 1L, __seg_hash) == std::accumulate(v, v + 10, 1L, __seg_hash);
+}
+
+//逐个迭代器读写，相当于没有分段快速路径时的copy和accumulate
+inline int deque_iterator_copy(const deque<int>& d, int* out) {
+	clock_t start = clock();
+	for (deque<int>::const_iterator it = d.begin(); it != d.end(); ++it)
+		*out++ = *it;
+	return (int)(static_cast<double>(clock() - start) / CLOCKS_PER_SEC * 1000);
+}
+inline int deque_segmented_copy(const deque<int>& d, int* out) {
+	clock_t start = clock();
+	lmstl::copy(d.begin(), d.end(), out);
+	return (int)(static_cast<double>(clock() - start) / CLOCKS_PER_SEC * 1000);
+}
+inline int deque_iterator_accumulate(const deque<int>& d, int* out) {
+	clock_t start = clock();
+	long sum = 0;
+	for (deque<int>::const_iterator it = d.begin(); it != d.end(); ++it)
+		sum += *it;
+	*out = (int)sum;
+	return (int)(static_cast<double>(clock() - start) / CLOCKS_PER_SEC * 1000);
+}
+inline int deque_segmented_accumulate(const deque<int>& d, int* out) {
+	clock_t start = clock();
+	*out = (int)lmstl::accumulate(d.begin(), d.end(), 0L);
+	return (int)(static_cast<double>(clock() - start) / CLOCKS_PER_SEC * 1000);
+}
+
+#define DEQUE_ALGO_TIMING(func, len) do{	\
+	deque<int> d(len, 1);	\
+	std::vector<int> out(len);	\
+	std::string t = std::to_string(func(d, out.data()));	\
+	t += "ms    |";	\
+	cout << std::setw(WIDE) << t;	\
+}while(0)
+
+#define DEQUE_ALGO_PERF_TEST(name, func, len1, len2, len3) do{	\
+	cout << "|---------------------|-------------|-------------|-------------|\n";	\
+	std::string l1(#len1), l2(#len2), l3(#len3);	\
+	l1+="   |";l2+="   |";l3+="   |";	\
+	cout << "|" << std::setw(WIDE2) << "deque<int>    |";	\
+	cout<<std::setw(WIDE)<<l1<<std::setw(WIDE)<<l2<<std::setw(WIDE)<<l3<<"\n|" << name;	\
+	DEQUE_ALGO_TIMING(func, len1);	\
+	DEQUE_ALGO_TIMING(func, len2);	\
+	DEQUE_ALGO_TIMING(func, len3);	\
+	cout << endl;	\
+}while(0)
+
+void deque_test() {
+	deque<int> md(3, 7);
+	std::deque<int> sd(3, 7);
+	API_TEST_START();
+	cout << "[-------------------- Container test : deque -------------------]\n";
+	API_TEST01(md, sd, push_back, 6);
+	API_TEST01(md, sd, push_front, 5);
+	API_TEST01(md, sd, pop_back, );
+	API_TEST01(md, sd, pop_front, );
+	for (int i = 0; i < 1000; ++i) {
+		md.push_back(i);
+		sd.push_back(i);
+		md.push_front(-i);
+		sd.push_front(-i);
+	}
+	API_COMPARE(md, sd);
+	API_TEST12(md, sd, insert, begin, , 500, 42);
+	API_TEST11(md, sd, erase, begin, , 1500);
+	API_TEST22(md, sd, erase, begin, begin, , 10, , 1200);
+	for (int i = 0; i < 600; ++i) {
+		md.pop_front();
+		sd.pop_front();
+	}
+	API_COMPARE(md, sd);
+	API_TEST01(md, sd, clear, );
+	API_TEST01(md, sd, push_front, 1);
+	API_CHECK("deque reuses freed blocks", deque_recycles_blocks());
+	cout << "[------------------ Algorithm test : segmented -----------------]\n";
+	API_CHECK("segmented algorithms on small deques", segmented_algo_ranges(0) && segmented_algo_ranges(1) && segmented_algo_ranges(127));
+	API_CHECK("segmented algorithms across blocks", segmented_algo_ranges(129) && segmented_algo_ranges(256) && segmented_algo_ranges(1000));
+	API_CHECK("copy into deque at block boundaries", copy_to_segmented_boundaries());
+	API_CHECK("adjacent_difference, partial_sum, accumulate with op", numeric_matches());
+	API_TEST_END();
+	PERF_TEST_START();
+	cout << "[------------------ Algorithm test : segmented -----------------]\n";
+	DEQUE_ALGO_PERF_TEST("   iterator copy     |", deque_iterator_copy, 1000000, 10000000, 50000000);
+	DEQUE_ALGO_PERF_TEST("   segmented copy    |", deque_segmented_copy, 1000000, 10000000, 50000000);
+	DEQUE_ALGO_PERF_TEST("iterator accumulate  |", deque_iterator_accumulate, 1000000, 10000000, 50000000);
+	DEQUE_ALGO_PERF_TEST("segmented accumulate |", deque_segmented_accumulate, 1000000, 10000000, 50000000);
+	PERF_TEST_END();
+}
+
+}
+
+#endif // !__LMSTL_DEQUE_TEST_H__
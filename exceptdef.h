@@ -7,5 +7,12 @@ namespace lmstl {
 #define __THROW_OUT_OF_RANGE_ERROR(expr, what) if((expr)) throw std::out_of_range(what);
 #define __THROW_BAD_ALLOC__ std::cerr<<"Out of Memory"<<std::endl; exit(1)
 
+//只在调试版本中做的越界检查，发布版本展开为空，operator[]只剩一次访存，循环可以被向量化
+#if defined(_DEBUG) || defined(__LMSTL_DEBUG)
+#define __DEBUG_THROW_OUT_OF_RANGE_ERROR(expr, what) __THROW_OUT_OF_RANGE_ERROR(expr, what)
+#else
+#define __DEBUG_THROW_OUT_OF_RANGE_ERROR(expr, what)
+#endif
+
 }
 #endif // !__LMSTL_EXCEPTDEF_H__
@@ -96,7 +96,7 @@ private:
 	typedef flist_node_base list_node_base;
 	typedef list_node* node_ptr;
 	typedef list_node_base* base_ptr;
-	typedef simple_alloc<list_node> node_allocator;
+	typedef simple_alloc<list_node, Alloc> node_allocator;
 
 	static node_ptr create_node(const value_type& x) {
 		node_ptr node = node_allocator::allocate(1);
@@ -149,9 +149,12 @@ public:
 
 	typedef hashtable_iterator<Key, Value, HashFcn, ExtractKey, EqualKey, Alloc> iterator;
 	typedef hashtable_const_iterator<Key, Value, HashFcn, ExtractKey, EqualKey, Alloc> const_iterator;
+	typedef Alloc allocator_type;
 
 	hasher hash_funct() const { return hash; }
 	key_equal key_eq() const { return equals; }
+	//分配器保存在buckets中，随buckets一起复制、移动和交换
+	allocator_type get_allocator() const { return buckets.get_allocator(); }
 
 private:
 	typedef hashtable_node<Value> node;
@@ -159,7 +162,7 @@ private:
 	typedef hashtable_node_base* base_ptr;
 	typedef simple_alloc<node, Alloc> node_allocator;
 
-	vector<node_ptr> buckets;
+	vector<node_ptr, Alloc> buckets;
 	size_type num_elements;
 	hasher hash;
 	key_equal equals;
@@ -173,13 +176,13 @@ private:
 	}
 
 	node_ptr new_node(const value_type& obj) {
-		node_ptr ret = node_allocator::allocate(1);
+		node_ptr ret = node_allocator::allocate(buckets.get_allocator(), 1);
 		ret->next = 0;
 		try {
 			construct(ret, obj);
 		}
 		catch (...) {
-			node_allocator::deallocate(ret, 1);
+			node_allocator::deallocate(buckets.get_allocator(), ret, 1);
 			__THROW_RUNTIME_ERROR(1, "Error when constructing");
 		}
 		return ret;
@@ -187,19 +190,19 @@ private:
 
 	void delete_node(node_ptr n) {
 		destroy(n);
-		node_allocator::deallocate(n, 1);
+		node_allocator::deallocate(buckets.get_allocator(), n, 1);
 	}
 
 public:
 	size_type bucket_count() const { return buckets.size(); }
 
-	hashtable(size_type n, const HashFcn& hf, const EqualKey& eqk) :
-		hash(hf), equals(eqk), get_key(ExtractKey()), num_elements(0) {
+	hashtable(size_type n, const HashFcn& hf, const EqualKey& eqk, const Alloc& a = Alloc()) :
+		buckets(a), hash(hf), equals(eqk), get_key(ExtractKey()), num_elements(0) {
 		init_buckets(n);
 	}
 
 	hashtable(const hashtable& ht) :
-		hash(ht.hash), equals(ht.equals), get_key(ht.get_key), num_elements(ht.num_elements) {
+		buckets(ht.get_allocator()), hash(ht.hash), equals(ht.equals), get_key(ht.get_key), num_elements(ht.num_elements) {
 		buckets.reserve(ht.buckets.size());
 		buckets.insert(buckets.begin(), ht.buckets.size(), (node_ptr)0);
 		try {
@@ -300,6 +303,7 @@ public:
 		while (optr) {
 			if (equals(k, get_key(optr->val)))
 				++ret;
+			optr = (node_ptr&)optr->next;
 		}
 		return ret;
 	}
@@ -421,7 +425,7 @@ public:
 		return pair<const_iterator, const_iterator>(iter1, iter2);
 	}
 
-	template <typename InputIterator, typename _BOOL = typename enable_if<is_input_iterator<InputIterator>::value>::type>
+	template <typename InputIterator, typename _BOOL = typename enable_if<is_input_iterator_v<InputIterator>>::type>
 	void insert_equal(InputIterator beg, InputIterator end) {
 		for (; beg != end; ++beg)
 			insert_equal(*beg);
@@ -477,19 +481,13 @@ public:
 		}
 		return ret;
 	}
-private:
-	void init_buckets(size_type n) {
-		const size_type n_buckets = _next_prime(n);
-		buckets.reserve(n_buckets);
-		buckets.insert(buckets.begin(), n_buckets, (node_ptr)0);
-		num_elements = 0;
-	}
 
+	//桶数扩充到不少于num个，批量插入前调用可以避免反复重新散列
 	void resize(size_type num) {
 		const size_type old = buckets.size();
 		if (num > old) {
 			const size_type nlen = _next_prime(num);
-			vector<node_ptr> tmp(nlen, (node*)0);
+			vector<node_ptr, Alloc> tmp(nlen, (node*)0, buckets.get_allocator());
 			try {
 				node_ptr optr;
 				size_type new_bk;
@@ -510,6 +508,13 @@ private:
 			}
 		}
 	}
+private:
+	void init_buckets(size_type n) {
+		const size_type n_buckets = _next_prime(n);
+		buckets.reserve(n_buckets);
+		buckets.insert(buckets.begin(), n_buckets, (node_ptr)0);
+		num_elements = 0;
+	}
 
 	size_type bkt_num(const value_type& obj) const {
 		return hash(get_key(obj)) % (buckets.size());
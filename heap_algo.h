@@ -2,6 +2,9 @@
 #define __LMSTL_HEAP_ALGO_H__
 
 #include "iterator.h"
+#include "utility.h"
+#include "functional.h"
+#include <stddef.h>
 
 namespace lmstl {
 
@@ -12,13 +15,27 @@ namespace lmstl {
 		value_type temp = *(end - 1);
 		difference_type i = (end - beg) - 1, j = (i - 1) / 2;
 		while (i && *(beg + j) < temp) {
-			*(end - 1) = *(beg + j);
+			*(beg + i) = *(beg + j);
 			i = j;
 			j = (j - 1) / 2;
 		}
 		*(beg + i) = temp;
 	}
 
+	template <typename RandomAccessIterator, typename Compare>
+	inline void push_heap(RandomAccessIterator beg, RandomAccessIterator end, Compare comp) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type difference_type;
+		value_type temp = lmstl::move(*(end - 1));
+		difference_type i = (end - beg) - 1, j = (i - 1) / 2;
+		while (i && comp(*(beg + j), temp)) {
+			*(beg + i) = lmstl::move(*(beg + j));
+			i = j;
+			j = (j - 1) / 2;
+		}
+		*(beg + i) = lmstl::move(temp);
+	}
+
 	template <typename RandomAccessIterator, typename difference_type, typename value_type>
 	inline void __adjust_heap(RandomAccessIterator beg, difference_type top, difference_type len, value_type val) {
 		difference_type i = top, j = 2 * i + 1;
@@ -57,7 +74,7 @@ namespace lmstl {
 		value_type temp = *(end - 1);
 		*(end - 1) = *beg;
 		difference_type len = (end - beg) - 1;
-		__adjust_heap(beg, 0, len, temp);
+		lmstl::__adjust_heap(beg, difference_type(0), len, temp);
 	}
 	
 	template <typename RandomAccessIterator, typename Compare>
@@ -67,7 +84,7 @@ namespace lmstl {
 		value_type temp = *(end - 1);
 		*(end - 1) = *beg;
 		difference_type len = (end - beg) - 1;
-		__adjust_heap(beg, 0, len, temp, comp);
+		lmstl::__adjust_heap(beg, difference_type(0), len, temp, comp);
 	}
 
 	template <typename RandomAccessIterator>
@@ -96,7 +113,7 @@ namespace lmstl {
 			return;
 		difference_type parent = (len - 2) / 2;
 		while (parent >= 0) {
-			__adjust_heap(beg, parent, len, *(beg + parent));
+			lmstl::__adjust_heap(beg, parent, len, *(beg + parent));
 			--parent;
 		}
 	}
@@ -110,11 +127,117 @@ namespace lmstl {
 			return;
 		difference_type parent = (len - 2) / 2;
 		while (parent >= 0) {
-			__adjust_heap(beg, parent, len, *(beg + parent), comp);
+			lmstl::__adjust_heap(beg, parent, len, *(beg + parent), comp);
 			--parent;
 		}
 	}
 
+	//d叉堆：结点i的子结点是d*i+1 ... d*i+d，父结点是(i-1)/d，D为2时与上面的二叉堆相同
+	//D越大树越矮，下滤的层数从log2(n)降到logD(n)，每层比较D个相邻的子结点
+	//Pad是序列开头空出不用的位置数，堆从beg + Pad开始；Pad取D-1时下标p的子结点从D*(p-D+2)开始，
+	//每组兄弟的起点都是D的倍数，存储按缓存行对齐且D*sizeof(T)整除缓存行大小时，一组兄弟正好占同一条缓存行
+	template <size_t D, size_t Pad, typename Distance>
+	inline Distance __dary_first_child(Distance i) {
+		return Distance(D) * (i - Distance(Pad)) + Distance(Pad) + 1;
+	}
+
+	template <size_t D, size_t Pad, typename Distance>
+	inline Distance __dary_parent(Distance i) {
+		return (i - Distance(Pad) - 1) / Distance(D) + Distance(Pad);
+	}
+
+	template <size_t D, size_t Pad, typename RandomAccessIterator, typename Distance, typename T, typename Compare>
+	inline void __adjust_dary_heap(RandomAccessIterator beg, Distance top, Distance len, T val, Compare comp) {
+		Distance i = top, child = lmstl::__dary_first_child<D, Pad>(i);
+		while (child < len) {
+			const Distance last = len - child < Distance(D) ? len : child + Distance(D);
+			Distance best = child;
+			for (Distance k = child + 1; k < last; ++k)
+				if (comp(*(beg + best), *(beg + k)))
+					best = k;
+			if (!comp(val, *(beg + best)))
+				break;
+			*(beg + i) = lmstl::move(*(beg + best));
+			i = best;
+			child = lmstl::__dary_first_child<D, Pad>(i);
+		}
+		*(beg + i) = lmstl::move(val);
+	}
+
+	template <size_t D, size_t Pad = 0, typename RandomAccessIterator, typename Compare>
+	inline void push_dary_heap(RandomAccessIterator beg, RandomAccessIterator end, Compare comp) {
+		static_assert(D >= 2, "a heap needs at least two children per node");
+		typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type difference_type;
+		value_type temp = lmstl::move(*(end - 1));
+		difference_type i = (end - beg) - 1;
+		while (i > difference_type(Pad)) {
+			const difference_type parent = lmstl::__dary_parent<D, Pad>(i);
+			if (!comp(*(beg + parent), temp))
+				break;
+			*(beg + i) = lmstl::move(*(beg + parent));
+			i = parent;
+		}
+		*(beg + i) = lmstl::move(temp);
+	}
+
+	template <size_t D, size_t Pad = 0, typename RandomAccessIterator>
+	inline void push_dary_heap(RandomAccessIterator beg, RandomAccessIterator end) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+		lmstl::push_dary_heap<D, Pad>(beg, end, less<value_type>());
+	}
+
+	template <size_t D, size_t Pad = 0, typename RandomAccessIterator, typename Compare>
+	inline void pop_dary_heap(RandomAccessIterator beg, RandomAccessIterator end, Compare comp) {
+		static_assert(D >= 2, "a heap needs at least two children per node");
+		typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type difference_type;
+		value_type temp = lmstl::move(*(end - 1));
+		*(end - 1) = lmstl::move(*(beg + Pad));
+		lmstl::__adjust_dary_heap<D, Pad>(beg, difference_type(Pad), (end - beg) - 1, lmstl::move(temp), comp);
+	}
+
+	template <size_t D, size_t Pad = 0, typename RandomAccessIterator>
+	inline void pop_dary_heap(RandomAccessIterator beg, RandomAccessIterator end) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+		lmstl::pop_dary_heap<D, Pad>(beg, end, less<value_type>());
+	}
+
+	template <size_t D, size_t Pad = 0, typename RandomAccessIterator, typename Compare>
+	inline void make_dary_heap(RandomAccessIterator beg, RandomAccessIterator end, Compare comp) {
+		static_assert(D >= 2, "a heap needs at least two children per node");
+		typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type difference_type;
+		const difference_type len = end - beg;
+		if (len - difference_type(Pad) < 2)
+			return;
+		for (difference_type parent = lmstl::__dary_parent<D, Pad>(len - 1); parent >= difference_type(Pad); --parent) {
+			value_type temp = lmstl::move(*(beg + parent));
+			lmstl::__adjust_dary_heap<D, Pad>(beg, parent, len, lmstl::move(temp), comp);
+		}
+	}
+
+	template <size_t D, size_t Pad = 0, typename RandomAccessIterator>
+	inline void make_dary_heap(RandomAccessIterator beg, RandomAccessIterator end) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+		lmstl::make_dary_heap<D, Pad>(beg, end, less<value_type>());
+	}
+
+	template <size_t D, size_t Pad = 0, typename RandomAccessIterator, typename Compare>
+	inline void dary_heap_sort(RandomAccessIterator beg, RandomAccessIterator end, Compare comp) {
+		typedef typename iterator_traits<RandomAccessIterator>::difference_type difference_type;
+		while (end - beg > difference_type(Pad) + 1) {
+			lmstl::pop_dary_heap<D, Pad>(beg, end, comp);
+			--end;
+		}
+	}
+
+	template <size_t D, size_t Pad = 0, typename RandomAccessIterator>
+	inline void dary_heap_sort(RandomAccessIterator beg, RandomAccessIterator end) {
+		typedef typename iterator_traits<RandomAccessIterator>::value_type value_type;
+		lmstl::dary_heap_sort<D, Pad>(beg, end, less<value_type>());
+	}
+
 }
 
 #endif // !__LMSTL__HEAP_ALGO_H__
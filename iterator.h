@@ -90,6 +90,34 @@ constexpr bool is_random_access_iterator_v = false;
 template <typename Iter>
 constexpr bool is_random_access_iterator_v<Iter, void_t<iter_cat<Iter>>> = std::is_convertible_v<iter_cat<Iter>, random_access_iterator_tag>;
 
+//分段迭代器：元素存放在若干段连续内存中（如deque的各个缓冲区），为迭代器特化这个类后，算法可以逐段用指针处理
+//segment(it)/local(it)取出所在的段和段内指针，begin(s)/end(s)是段s的范围，compose(s, p)重新组成迭代器
+template <typename Iter>
+struct segmented_iterator_traits {
+	static const bool is_segmented = false;
+};
+
+template <typename Iter>
+constexpr bool is_segmented_iterator_v = segmented_iterator_traits<Iter>::is_segmented;
+
+//对[beg, end)中的每一段连续内存调用f(segment, first, last)，f返回false时提前结束
+template <typename SegIter, typename Function>
+inline void __for_each_segment(SegIter beg, SegIter end, Function f) {
+	typedef segmented_iterator_traits<SegIter> traits;
+	typename traits::segment_iterator sb = traits::segment(beg);
+	typename traits::segment_iterator se = traits::segment(end);
+	if (sb == se) {
+		f(sb, traits::local(beg), traits::local(end));
+		return;
+	}
+	if (!f(sb, traits::local(beg), traits::end(sb)))
+		return;
+	for (++sb; sb != se; ++sb)
+		if (!f(sb, traits::begin(sb), traits::end(sb)))
+			return;
+	f(se, traits::begin(se), traits::local(end));
+}
+
 template <typename InputIterator, typename Distance>
 inline void __advance(InputIterator& i, Distance d, input_iterator_tag) {
 	while (d--)
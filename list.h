@@ -90,7 +90,7 @@ bool operator!=(const list_iterator<T, Ref, Ptr>& l, const list_iterator<T, Ref,
 }
 
 template <typename T, typename Alloc = alloc>
-class list {
+class list : private alloc_holder<Alloc> {
 
 public:
 	typedef T										value_type;
@@ -108,10 +108,12 @@ public:
 	typedef list_iterator<T, const T&, const T*>	const_iterator;
 	typedef reverse_iterator<const_iterator>		const_reverse_iterator;
 	typedef reverse_iterator<iterator>				reverse_iterator;
+	typedef Alloc									allocator_type;
 
 protected:
 	node_ptr node;
 	typedef list_node_base* base_ptr;
+	typedef alloc_holder<Alloc> alloc_base;
 
 public:
 	iterator begin() {
@@ -148,7 +150,7 @@ public:
 		return (node == node->next);
 	}
 	size_type size() const {
-		return distance(begin(), end());
+		return lmstl::distance(begin(), end());
 	}
 	reference front() {
 		return ((node_ptr&)(node->next))->data;
@@ -168,8 +170,8 @@ public:
 	}
 
 protected:
-	node_ptr get_node() { return data_allocator::allocate(1); }
-	void put_node(node_ptr x) { data_allocator::deallocate(x, 1); }
+	node_ptr get_node() { return data_allocator::allocate(this->get_alloc(), 1); }
+	void put_node(node_ptr x) { data_allocator::deallocate(this->get_alloc(), x, 1); }
 
 	node_ptr create_node(const T& x) {
 		node_ptr p = get_node();
@@ -190,20 +192,30 @@ public:
 	list() {
 		init();
 	}
-	list(size_type n, const T& val) {
+	explicit list(const Alloc& a):
+		alloc_base(a) {
+		init();
+	}
+	list(size_type n, const T& val, const Alloc& a = Alloc()):
+		alloc_base(a) {
 		init();
 		for (; n; --n)
 			__insert(node, val);
 	}
-	list(const list& x) {
+	list(const list& x):
+		alloc_base(x.get_alloc()) {
 		init();
 		size_type n = x.size();
 		copy_insert(node, x.begin(), n);
 	}
-	list(list&& x) noexcept :
-		node(x.node) {
-		x.node = 0;
+	list(list&& x):
+		alloc_base(x.get_alloc()) {
+		init();
+		swap(x);
 	}
+
+	allocator_type get_allocator() const { return this->get_alloc(); }
+
 	iterator insert(iterator position, const T& x) {
 		node_ptr p = create_node(x);
 		p->next = position.node;
@@ -226,7 +238,7 @@ public:
 	void insert(iterator position, InputIter beg, InputIter end){
 		if (beg == end)
 			return;
-		size_type n = distance(beg, end);
+		size_type n = lmstl::distance(beg, end);
 		copy_insert((node_ptr&)position.node, beg, n);
 	}
 
@@ -295,7 +307,7 @@ public:
 	~list() {
 		if (node) {
 			clear();
-			data_allocator::deallocate(node, 1);
+			put_node(node);
 		}
 	}
 	void clear() {
@@ -360,13 +372,36 @@ public:
 		node_ptr tmp = node;
 		node = x.node;
 		x.node = tmp;
+		this->swap_alloc(x);
 	}
 
 	void merge(list<T, Alloc>& x) {
-		iterator beg1 = begin();
-		iterator end1 = end();
-		iterator beg2 = x.begin();
-		iterator end2 = x.end();
+		merge_heads(node, x.node);
+	}
+
+protected:
+	static void init_head(base_ptr h) {
+		h->next = h;
+		h->prev = h;
+	}
+	//把from中的全部节点移到to的末尾
+	void splice_all(base_ptr to, base_ptr from) {
+		if (from->next != from)
+			transfer(iterator(to), iterator(from->next), iterator(from));
+	}
+	void swap_heads(base_ptr x, base_ptr y) {
+		list_node_base tmp;
+		init_head(&tmp);
+		splice_all(&tmp, x);
+		splice_all(x, y);
+		splice_all(y, &tmp);
+	}
+	//把以y为表头的有序链表并入以x为表头的有序链表
+	void merge_heads(base_ptr x, base_ptr y) {
+		iterator beg1 = x->next;
+		iterator end1 = x;
+		iterator beg2 = y->next;
+		iterator end2 = y;
 		while (beg1 != end1 && beg2 != end2) {
 			if (*beg2 < *beg1) {
 				iterator next = beg2;
@@ -380,6 +415,7 @@ public:
 			transfer(end1, beg2, end2);
 	}
 
+public:
 	void reverse() {
 		if (node->next == node || node->next->next == node)
 			return;
@@ -396,22 +432,27 @@ public:
 	void sort() {
 		if (node->next == node || node->next->next == node)
 			return;
-		list<T, Alloc> carry;
-		list<T, Alloc> counter[64];
+		//carry与counter只用栈上的表头节点中转，不向分配器申请内存
+		list_node_base carry;
+		list_node_base counter[64];
+		init_head(&carry);
+		for (int k = 0; k < 64; ++k)
+			init_head(counter + k);
 		int fill = 0, i;
 		while (!empty()) {
-			carry.splice(carry.begin(), begin());
+			iterator first = begin(), second = first;
+			transfer(iterator(&carry), first, ++second);
 			i = 0;
-			while (i < fill && !counter[i].empty()) {
-				counter[i].merge(carry);
-				carry.swap(counter[i++]);
+			while (i < fill && counter[i].next != counter + i) {
+				merge_heads(counter + i, &carry);
+				swap_heads(&carry, counter + i++);
 			}
-			carry.swap(counter[i]);
+			swap_heads(&carry, counter + i);
 			if (i == fill) ++fill;
 		}
 		for (i = 1; i < fill; ++i)
-			counter[i].merge(counter[i - 1]);
-		swap(counter[fill - 1]);
+			merge_heads(counter + i, counter + i - 1);
+		splice_all(node, counter + fill - 1);
 	}
 };
 
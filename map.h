@@ -17,6 +17,7 @@ public:
 	typedef T mapped_type;
 	typedef pair<const key_type, data_type> value_type;
 	typedef Compare key_compare;
+	typedef Alloc allocator_type;
 
 private:
 	typedef rb_tree<key_type, value_type, select1st<value_type>, key_compare, Alloc> rep_type;
@@ -39,6 +40,12 @@ public:
 	map():
 		t(Compare()) {}
 
+	explicit map(const Alloc& a):
+		t(Compare(), a) {}
+
+	map(const Compare& comp, const Alloc& a):
+		t(comp, a) {}
+
 	explicit map(const Compare& comp):
 		t(comp) {}
 
@@ -71,6 +78,8 @@ public:
 	}
 
 	key_compare key_comp() const { return t.key_comp(); }
+	allocator_type get_allocator() const { return t.get_allocator(); }
+	void swap(map& x) { t.swap(x.t); }
 
 	iterator begin() noexcept { return t.begin(); }
 	const_iterator begin() const noexcept { return t.begin(); }
@@ -105,6 +114,11 @@ public:
 		t.insert_unique(beg, end);
 	}
 
+	template <typename ForwardIterator>
+	void assign_sorted(ForwardIterator beg, ForwardIterator end) {
+		t.assign_sorted_unique(beg, end);
+	}
+
 	void erase(iterator position) {
 		t.erase(position);
 	}
@@ -166,6 +180,7 @@ public:
 	typedef T mapped_type;
 	typedef pair<const key_type, data_type> value_type;
 	typedef Compare key_compare;
+	typedef Alloc allocator_type;
 
 private:
 	typedef rb_tree<key_type, value_type, select1st<value_type>, key_compare, Alloc> rep_type;
@@ -185,6 +200,12 @@ public:
 	multimap() :
 		t(Compare()) {}
 
+	explicit multimap(const Alloc& a):
+		t(Compare(), a) {}
+
+	multimap(const Compare& comp, const Alloc& a):
+		t(comp, a) {}
+
 	explicit multimap(const Compare& comp) :
 		t(comp) {}
 
@@ -209,6 +230,8 @@ public:
 	}
 
 	key_compare key_comp() const { return t.key_comp(); }
+	allocator_type get_allocator() const { return t.get_allocator(); }
+	void swap(multimap& x) { t.swap(x.t); }
 
 	iterator begin() { return t.begin(); }
 	const_iterator begin() const { return t.begin(); }
@@ -226,6 +249,11 @@ public:
 		t.insert_equal(beg, end);
 	}
 
+	template <typename ForwardIterator>
+	void assign_sorted(ForwardIterator beg, ForwardIterator end) {
+		t.assign_sorted_equal(beg, end);
+	}
+
 	void erase(iterator position) {
 		t.erase(position);
 	}
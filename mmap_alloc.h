@@ -0,0 +1,149 @@
+#ifndef __LMSTL_MMAP_ALLOC_H__
+#define __LMSTL_MMAP_ALLOC_H__
+
+#include "alloc.h"
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace lmstl {
+
+	static const size_t __MMAP_THRESHOLD = 1024 * 1024;
+	static const size_t __HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+	//不小于Threshold字节的请求直接向操作系统映射整页，更小的请求交给Fallback
+	//Linux上reallocate用mremap重映射页表，不复制数据；其他平台以及大页映射无法原地伸缩时分配新区域后复制
+	//HugePages为true时映射按2M对齐并madvise(MADV_HUGEPAGE)，减少扫描大数组时的TLB缺失
+	template <bool HugePages = false, size_t Threshold = __MMAP_THRESHOLD, class Fallback = malloc_alloc>
+	class basic_mmap_alloc {
+	public:
+		static void* allocate(size_t n) {
+			if (n < Threshold)
+				return Fallback::allocate(n);
+			return map(map_length(n));
+		}
+		static void deallocate(void* p, size_t n) {
+			if (!p)
+				return;
+			if (n < Threshold)
+				Fallback::deallocate(p, n);
+			else
+				unmap(p, map_length(n));
+		}
+		static void* reallocate(void*, size_t, size_t);
+
+		static size_t page_size();
+
+	private:
+		static size_t map_length(size_t n) {
+			const size_t page = HugePages ? __HUGE_PAGE_SIZE : page_size();
+			return (n + page - 1) & ~(page - 1);
+		}
+		static void* map(size_t);
+		static void unmap(void*, size_t);
+	};
+
+	template <bool HugePages, size_t Threshold, class Fallback>
+	size_t basic_mmap_alloc<HugePages, Threshold, Fallback>::page_size() {
+#ifdef _WIN32
+		static const size_t page = [] {
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return (size_t)info.dwPageSize;
+		}();
+#else
+		static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+		return page;
+	}
+
+	//Windows的大页需要SeLockMemoryPrivilege权限，这里一律使用普通页
+	template <bool HugePages, size_t Threshold, class Fallback>
+	void* basic_mmap_alloc<HugePages, Threshold, Fallback>::map(size_t len) {
+#ifdef _WIN32
+		void* p = VirtualAlloc(0, len, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (!p) {
+			__THROW_BAD_ALLOC__;
+		}
+		return p;
+#else
+		if (!HugePages) {
+			void* p = mmap(0, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (p == MAP_FAILED) {
+				__THROW_BAD_ALLOC__;
+			}
+			return p;
+		}
+		//多映射一个大页再裁掉首尾，使起始地址按大页对齐
+		const size_t raw_len = len + __HUGE_PAGE_SIZE;
+		char* raw = (char*)mmap(0, raw_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (raw == (char*)MAP_FAILED) {
+			__THROW_BAD_ALLOC__;
+		}
+		char* p = (char*)(((size_t)raw + __HUGE_PAGE_SIZE - 1) & ~(__HUGE_PAGE_SIZE - 1));
+		if (p != raw)
+			munmap(raw, p - raw);
+		if (p + len != raw + raw_len)
+			munmap(p + len, raw + raw_len - (p + len));
+#ifdef MADV_HUGEPAGE
+		madvise(p, len, MADV_HUGEPAGE);
+#endif
+		return p;
+#endif
+	}
+
+	template <bool HugePages, size_t Threshold, class Fallback>
+	void basic_mmap_alloc<HugePages, Threshold, Fallback>::unmap(void* p, size_t len) {
+#ifdef _WIN32
+		VirtualFree(p, 0, MEM_RELEASE);
+#else
+		munmap(p, len);
+#endif
+	}
+
+	//两端都是映射时按页重映射，都在Fallback中时交给Fallback，跨越阈值时分配新块后复制
+	template <bool HugePages, size_t Threshold, class Fallback>
+	void* basic_mmap_alloc<HugePages, Threshold, Fallback>::reallocate(void* p, size_t old_sz, size_t new_sz) {
+		if (!p || !old_sz)
+			return allocate(new_sz);
+		if (old_sz < Threshold && new_sz < Threshold) {
+			if constexpr (__has_reallocate<Fallback>::value)
+				return Fallback::reallocate(p, old_sz, new_sz);
+		}
+		if (old_sz >= Threshold && new_sz >= Threshold) {
+			const size_t old_len = map_length(old_sz);
+			const size_t new_len = map_length(new_sz);
+			if (old_len == new_len)
+				return p;
+#ifdef __linux__
+			//mremap搬走的映射只按普通页对齐，大页映射只在原地伸缩，原地放不下时映射新的对齐区域再复制
+			void* ret = mremap(p, old_len, new_len, HugePages ? 0 : MREMAP_MAYMOVE);
+			if (ret != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+				if (HugePages)
+					madvise(ret, new_len, MADV_HUGEPAGE);
+#endif
+				return ret;
+			}
+			if (!HugePages) {
+				__THROW_BAD_ALLOC__;
+			}
+#endif
+		}
+		void* ret = allocate(new_sz);
+		memcpy(ret, p, old_sz < new_sz ? old_sz : new_sz);
+		deallocate(p, old_sz);
+		return ret;
+	}
+
+	typedef basic_mmap_alloc<false> mmap_alloc;
+	typedef basic_mmap_alloc<true> huge_page_alloc;
+
+}
+#endif // !__LMSTL_MMAP_ALLOC_H__
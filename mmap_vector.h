@@ -0,0 +1,412 @@
+#ifndef __LMSTL_MMAP_VECTOR_H__
+#define __LMSTL_MMAP_VECTOR_H__
+
+#include "iterator.h"
+#include "exceptdef.h"
+#include "algobase.h"
+#include "vector.h"
+#include <type_traits>
+#include <stdexcept>
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace lmstl {
+
+enum mmap_mode {
+	mmap_read_only,		//只读打开已有文件，修改操作抛出异常
+	mmap_read_write,	//读写打开，文件不存在时创建
+	mmap_create			//读写打开并清空原有内容
+};
+
+//把整个文件映射进内存，resize改变文件长度后重新映射，之前取得的指针全部失效
+class mapped_file {
+public:
+	mapped_file(const char* path, mmap_mode mode);
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+	~mapped_file() { close(); }
+
+	char* data() const noexcept { return addr; }
+	size_t size() const noexcept { return len; }
+	bool writable() const noexcept { return can_write; }
+
+	void resize(size_t);
+	void sync();
+	void close();
+
+private:
+	char* addr;
+	size_t len;
+	bool can_write;
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int fd;
+#endif
+
+	void map();
+	void unmap();
+};
+
+#ifdef _WIN32
+
+inline mapped_file::mapped_file(const char* path, mmap_mode mode):
+	addr(0), len(0), can_write(mode != mmap_read_only), mapping(0) {
+	file = CreateFileA(path, can_write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, 0,
+		mode == mmap_read_only ? OPEN_EXISTING : mode == mmap_create ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+	__THROW_RUNTIME_ERROR(file == INVALID_HANDLE_VALUE, "mapped_file: cannot open file");
+	LARGE_INTEGER sz;
+	GetFileSizeEx(file, &sz);
+	len = (size_t)sz.QuadPart;
+	try {
+		map();
+	}
+	catch (...) {
+		close();
+		throw;
+	}
+}
+
+inline void mapped_file::map() {
+	if (!len)
+		return;
+	mapping = CreateFileMappingA(file, 0, can_write ? PAGE_READWRITE : PAGE_READONLY,
+		(DWORD)((unsigned long long)len >> 32), (DWORD)(len & 0xffffffff), 0);
+	__THROW_RUNTIME_ERROR(!mapping, "mapped_file: cannot map file");
+	addr = (char*)MapViewOfFile(mapping, can_write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, len);
+	__THROW_RUNTIME_ERROR(!addr, "mapped_file: cannot map file");
+}
+
+inline void mapped_file::unmap() {
+	if (addr)
+		UnmapViewOfFile(addr);
+	if (mapping)
+		CloseHandle(mapping);
+	addr = 0;
+	mapping = 0;
+}
+
+inline void mapped_file::resize(size_t n) {
+	unmap();
+	LARGE_INTEGER pos;
+	pos.QuadPart = (LONGLONG)n;
+	__THROW_RUNTIME_ERROR(!SetFilePointerEx(file, pos, 0, FILE_BEGIN) || !SetEndOfFile(file), "mapped_file: cannot resize file");
+	len = n;
+	map();
+}
+
+inline void mapped_file::sync() {
+	if (addr) {
+		FlushViewOfFile(addr, len);
+		FlushFileBuffers(file);
+	}
+}
+
+inline void mapped_file::close() {
+	unmap();
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+	file = INVALID_HANDLE_VALUE;
+	len = 0;
+}
+
+#else
+
+inline mapped_file::mapped_file(const char* path, mmap_mode mode):
+	addr(0), len(0), can_write(mode != mmap_read_only) {
+	int flags = mode == mmap_read_only ? O_RDONLY : mode == mmap_create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR | O_CREAT;
+	fd = ::open(path, flags, 0644);
+	__THROW_RUNTIME_ERROR(fd < 0, "mapped_file: cannot open file");
+	struct stat st;
+	fstat(fd, &st);
+	len = (size_t)st.st_size;
+	try {
+		map();
+	}
+	catch (...) {
+		close();
+		throw;
+	}
+}
+
+inline void mapped_file::map() {
+	if (!len)
+		return;
+	void* p = mmap(0, len, can_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	__THROW_RUNTIME_ERROR(p == MAP_FAILED, "mapped_file: cannot map file");
+	addr = (char*)p;
+}
+
+inline void mapped_file::unmap() {
+	if (addr)
+		munmap(addr, len);
+	addr = 0;
+}
+
+//Linux上用mremap就地调整映射，其他平台先解除映射再重新映射
+inline void mapped_file::resize(size_t n) {
+#ifdef __linux__
+	if (addr && n) {
+		if (n > len)
+			__THROW_RUNTIME_ERROR(ftruncate(fd, (off_t)n) != 0, "mapped_file: cannot resize file");
+		void* p = mremap(addr, len, n, MREMAP_MAYMOVE);
+		__THROW_RUNTIME_ERROR(p == MAP_FAILED, "mapped_file: cannot map file");
+		addr = (char*)p;
+		if (n < len)
+			__THROW_RUNTIME_ERROR(ftruncate(fd, (off_t)n) != 0, "mapped_file: cannot resize file");
+		len = n;
+		return;
+	}
+#endif
+	unmap();
+	__THROW_RUNTIME_ERROR(ftruncate(fd, (off_t)n) != 0, "mapped_file: cannot resize file");
+	len = n;
+	map();
+}
+
+inline void mapped_file::sync() {
+	if (addr)
+		msync(addr, len, MS_SYNC);
+}
+
+inline void mapped_file::close() {
+	unmap();
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+	len = 0;
+}
+
+#endif // _WIN32
+
+//文件开头的固定长度头部，元素从__MMAP_VECTOR_HEADER偏移处开始紧密排列
+struct __mmap_vector_header {
+	uint64_t magic;
+	uint64_t elem_size;
+	uint64_t size;
+};
+
+static const uint64_t __MMAP_VECTOR_MAGIC = 0x314345564d4d4c00ULL;
+static const size_t __MMAP_VECTOR_HEADER = 64;
+
+//以文件为存储的vector，只接受可平凡复制的T：打开文件即可直接使用其中的元素，无需反序列化
+//容量不足时按Growth扩展文件长度；元素个数在sync()和析构时写回文件头部
+template <typename T, typename Growth = default_growth>
+class mmap_vector {
+	static_assert(std::is_trivially_copyable<T>::value, "mmap_vector requires a trivially copyable T");
+	static_assert(alignof(T) <= __MMAP_VECTOR_HEADER, "mmap_vector cannot align T");
+
+public:
+	typedef T					value_type;
+	typedef value_type*			pointer;
+	typedef const value_type*	const_pointer;
+	typedef value_type&			reference;
+	typedef const value_type&	const_reference;
+	typedef ptrdiff_t			difference_type;
+	typedef size_t				size_type;
+
+	typedef value_type*			iterator;
+	typedef const value_type*	const_iterator;
+	typedef reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef reverse_iterator<iterator> reverse_iterator;
+
+public:
+	explicit mmap_vector(const char* path, mmap_mode mode = mmap_read_write);
+	mmap_vector(const mmap_vector&) = delete;
+	mmap_vector& operator=(const mmap_vector&) = delete;
+	~mmap_vector() {
+		if (file.writable())
+			header()->size = count;
+	}
+
+private:
+	mapped_file file;
+	size_type count;
+
+	__mmap_vector_header* header() const noexcept { return (__mmap_vector_header*)file.data(); }
+	pointer start() const noexcept { return (pointer)(file.data() + __MMAP_VECTOR_HEADER); }
+	void check_writable() const {
+		__THROW_RUNTIME_ERROR(!file.writable(), "mmap_vector opened read-only");
+	}
+	void reallocate_storage(size_type n) {
+		file.resize(__MMAP_VECTOR_HEADER + n * sizeof(T));
+	}
+	//为再放n个元素腾出空间，返回原下标
+	size_type make_room(const_iterator pos, size_type n) {
+		check_writable();
+		const size_type index = pos - start();
+		if (capacity() - count < n)
+			reallocate_storage(Growth::next(capacity(), count + n, sizeof(T)));
+		if (index != count)
+			std::memmove((void*)(start() + index + n), (const void*)(start() + index), (count - index) * sizeof(T));
+		count += n;
+		return index;
+	}
+
+public:
+
+	iterator begin() noexcept { return start(); }
+	const_iterator begin() const noexcept { return start(); }
+	const_iterator cbegin() const noexcept { return start(); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+	iterator end() noexcept { return start() + count; }
+	const_iterator end() const noexcept { return start() + count; }
+	const_iterator cend() const noexcept { return start() + count; }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+	size_type size() const noexcept { return count; }
+	size_type capacity() const noexcept { return (file.size() - __MMAP_VECTOR_HEADER) / sizeof(T); }
+	bool empty() const noexcept { return count == 0; }
+	bool writable() const noexcept { return file.writable(); }
+
+	pointer data() noexcept { return start(); }
+	const_pointer data() const noexcept { return start(); }
+
+	reference operator[](size_type n) {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return start()[n];
+	}
+	const_reference operator[](size_type n) const {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return start()[n];
+	}
+
+	reference at(size_type n) {
+		__THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return start()[n];
+	}
+	const_reference at(size_type n) const {
+		__THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return start()[n];
+	}
+
+	reference unchecked_at(size_type n) noexcept { return start()[n]; }
+	const_reference unchecked_at(size_type n) const noexcept { return start()[n]; }
+
+	reference front() noexcept { return start()[0]; }
+	const_reference front() const noexcept { return start()[0]; }
+	reference back() noexcept { return start()[count - 1]; }
+	const_reference back() const noexcept { return start()[count - 1]; }
+
+	void push_back(const T& val) {
+		if (count != capacity()) {
+			check_writable();
+			start()[count++] = val;
+		}
+		else {
+			T val_copy = val;
+			const size_type index = make_room(end(), 1);
+			start()[index] = val_copy;
+		}
+	}
+
+	template <typename... Args>
+	void emplace_back(Args&&... args) {
+		push_back(T(lmstl::forward<Args>(args)...));
+	}
+
+	void pop_back() {
+		__THROW_RUNTIME_ERROR(empty(), "pop_back on empty mmap_vector");
+		check_writable();
+		--count;
+	}
+
+	iterator erase(iterator xbeg, iterator xend) {
+		__THROW_OUT_OF_RANGE_ERROR(!(xbeg <= xend && xbeg >= begin() && xend <= end()), "Range Error");
+		check_writable();
+		std::memmove((void*)xbeg, (const void*)xend, (end() - xend) * sizeof(T));
+		count -= xend - xbeg;
+		return xbeg;
+	}
+	iterator erase(iterator pos) {
+		__THROW_OUT_OF_RANGE_ERROR((pos >= end() || pos < begin()), "Range Error");
+		return erase(pos, pos + 1);
+	}
+
+	iterator insert(const_iterator pos, const T& val) {
+		T val_copy = val;
+		const size_type index = make_room(pos, 1);
+		start()[index] = val_copy;
+		return start() + index;
+	}
+	iterator insert(const_iterator pos, size_type n, const T& val) {
+		T val_copy = val;
+		const size_type index = make_room(pos, n);
+		lmstl::fill_n(start() + index, n, val_copy);
+		return start() + index;
+	}
+	template <typename InputIterator, typename = typename enable_if<is_input_iterator_v<InputIterator>>::type>
+	iterator insert(const_iterator pos, InputIterator beg, InputIterator end) {
+		const size_type index = make_room(pos, (size_type)lmstl::distance(beg, end));
+		lmstl::copy(beg, end, start() + index);
+		return start() + index;
+	}
+
+	void reserve(size_type n) {
+		check_writable();
+		if (n > capacity())
+			reallocate_storage(n);
+	}
+
+	void resize(size_type n, const T& val = T()) {
+		if (n > count)
+			insert(end(), n - count, val);
+		else if (n < count)
+			erase(begin() + n, end());
+	}
+
+	void clear() {
+		check_writable();
+		count = 0;
+	}
+
+	//截断文件到恰好容纳现有元素
+	void shrink_to_fit() {
+		check_writable();
+		if (count != capacity())
+			reallocate_storage(count);
+	}
+
+	//写回元素个数并把修改刷到磁盘
+	void sync() {
+		if (file.writable()) {
+			header()->size = count;
+			file.sync();
+		}
+	}
+};
+
+template <typename T, typename Growth>
+mmap_vector<T, Growth>::mmap_vector(const char* path, mmap_mode mode):
+	file(path, mode), count(0) {
+	if (file.size() == 0) {
+		check_writable();
+		file.resize(__MMAP_VECTOR_HEADER);
+		header()->magic = __MMAP_VECTOR_MAGIC;
+		header()->elem_size = sizeof(T);
+		header()->size = 0;
+		return;
+	}
+	__THROW_RUNTIME_ERROR(file.size() < __MMAP_VECTOR_HEADER || header()->magic != __MMAP_VECTOR_MAGIC,
+		"mmap_vector: not an mmap_vector file");
+	__THROW_RUNTIME_ERROR(header()->elem_size != sizeof(T), "mmap_vector: element size mismatch");
+	__THROW_RUNTIME_ERROR(header()->size > capacity(), "mmap_vector: truncated file");
+	count = (size_type)header()->size;
+}
+
+}
+#endif // !__LMSTL_MMAP_VECTOR_H__
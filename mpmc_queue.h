@@ -0,0 +1,165 @@
+#ifndef __LMSTL_MPMC_QUEUE_H__
+#define __LMSTL_MPMC_QUEUE_H__
+
+#include "alloc.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "type_traits.h"
+#include "utility.h"
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <thread>
+#include <stdexcept>
+#include <stddef.h>
+
+namespace lmstl {
+
+#ifndef __LMSTL_CACHE_LINE_SIZE
+#define __LMSTL_CACHE_LINE_SIZE 64
+#endif
+
+template <typename T>
+struct __mpmc_slot {
+	std::atomic<size_t> seq;
+	alignas(T) unsigned char storage[sizeof(T)];
+
+	T* ptr() noexcept { return reinterpret_cast<T*>(storage); }
+};
+
+//有界无锁的多生产者多消费者队列，容量向上取整为2的幂，槽位数组在构造时一次分配，之后不再分配内存
+//每个槽位带一个序号：seq == pos表示可以写入位置pos，seq == pos + 1表示位置pos的元素已经写好可以读取
+//生产者和消费者分别用CAS抢占tail和head上的位置，抢到后独占该槽位，读写完再发布新的序号
+template <typename T, typename Alloc = alloc>
+class mpmc_queue : private alloc_holder<Alloc> {
+	static_assert(std::is_nothrow_move_constructible<T>::value, "mpmc_queue needs a nothrow move constructible T");
+
+public:
+	typedef T			value_type;
+	typedef T&			reference;
+	typedef const T&	const_reference;
+	typedef size_t		size_type;
+	typedef Alloc		allocator_type;
+
+private:
+	typedef __mpmc_slot<T> slot;
+	typedef simple_alloc<slot, Alloc> slot_allocator;
+	typedef alloc_holder<Alloc> alloc_base;
+
+	slot* slots;
+	size_type mask;
+
+	alignas(__LMSTL_CACHE_LINE_SIZE) std::atomic<size_type> tail;
+	alignas(__LMSTL_CACHE_LINE_SIZE) std::atomic<size_type> head;
+
+public:
+	explicit mpmc_queue(size_type n, const Alloc& a = Alloc()):
+		alloc_base(a), slots(0), mask(0), tail(0), head(0) {
+		__THROW_OUT_OF_RANGE_ERROR(n == 0, "mpmc_queue needs a non-zero capacity");
+		size_type cap = 1;
+		while (cap < n)
+			cap <<= 1;
+		slots = slot_allocator::allocate(this->get_alloc(), cap);
+		for (size_type i = 0; i != cap; ++i)
+			new((void*)&slots[i].seq) std::atomic<size_type>(i);
+		mask = cap - 1;
+	}
+	mpmc_queue(const mpmc_queue&) = delete;
+	mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+	~mpmc_queue() {
+		const size_type t = tail.load(std::memory_order_relaxed);
+		for (size_type h = head.load(std::memory_order_relaxed); h != t; ++h)
+			destroy(slots[h & mask].ptr());
+		slot_allocator::deallocate(this->get_alloc(), slots, mask + 1);
+	}
+
+	allocator_type get_allocator() const { return this->get_alloc(); }
+
+	size_type capacity() const noexcept { return mask + 1; }
+	//其他线程同时在操作时只是一个近似值
+	size_type size() const noexcept {
+		const size_type h = head.load(std::memory_order_acquire);
+		const size_type t = tail.load(std::memory_order_acquire);
+		return t > h ? t - h : 0;
+	}
+	bool empty() const noexcept { return size() == 0; }
+
+	bool try_push(const value_type& val) { return try_emplace(val); }
+	bool try_push(value_type&& val) { return try_emplace(lmstl::move(val)); }
+
+	//队列满时返回false
+	//抢到的槽位无法退回，构造可能抛异常时先在槽位外构造好，抢到槽位后只做不抛异常的移动构造
+	template <typename... Args>
+	bool try_emplace(Args&&... args) {
+		if constexpr (!std::is_nothrow_constructible<T, Args&&...>::value) {
+			T tmp(lmstl::forward<Args>(args)...);
+			return try_emplace(lmstl::move(tmp));
+		}
+		size_type pos = tail.load(std::memory_order_relaxed);
+		slot* s;
+		for (;;) {
+			s = &slots[pos & mask];
+			const size_type seq = s->seq.load(std::memory_order_acquire);
+			const ptrdiff_t diff = (ptrdiff_t)(seq - pos);
+			if (diff == 0) {
+				if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				pos = tail.load(std::memory_order_relaxed);
+		}
+		new((void*)s->ptr()) T(lmstl::forward<Args>(args)...);
+		s->seq.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	//队列空时返回false
+	bool try_pop(value_type& out) {
+		size_type pos = head.load(std::memory_order_relaxed);
+		slot* s;
+		for (;;) {
+			s = &slots[pos & mask];
+			const size_type seq = s->seq.load(std::memory_order_acquire);
+			const ptrdiff_t diff = (ptrdiff_t)(seq - (pos + 1));
+			if (diff == 0) {
+				if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				pos = head.load(std::memory_order_relaxed);
+		}
+		//抢到的槽位必须归还，先不抛异常地移出元素并发布槽位，再赋值给out
+		T tmp(lmstl::move(*s->ptr()));
+		destroy(s->ptr());
+		s->seq.store(pos + mask + 1, std::memory_order_release);
+		out = lmstl::move(tmp);
+		return true;
+	}
+
+	//队列满时自旋等待
+	void push(const value_type& val) {
+		push(value_type(val));
+	}
+	void push(value_type&& val) {
+		while (!try_push(lmstl::move(val)))
+			std::this_thread::yield();
+	}
+	template <typename... Args>
+	void emplace(Args&&... args) {
+		push(T(lmstl::forward<Args>(args)...));
+	}
+
+	//队列空时自旋等待
+	void pop(value_type& out) {
+		while (!try_pop(out))
+			std::this_thread::yield();
+	}
+};
+
+}
+#endif // !__LMSTL_MPMC_QUEUE_H__
@@ -7,18 +7,34 @@ namespace lmstl {
 
 template <typename InputIterator, typename T>
 T accumulate(InputIterator beg, InputIterator end, T init) {
-	for (; beg != end; ++beg)
-		init = init + *beg;
+	if constexpr (is_segmented_iterator_v<InputIterator>) {
+		__for_each_segment(beg, end, [&](auto, auto first, auto last) {
+			init = lmstl::accumulate(first, last, init);
+			return true;
+		});
+	}
+	else {
+		for (; beg != end; ++beg)
+			init = init + *beg;
+	}
 	return init;
 }
-/*
-template <typename InputIterator, typename T>
+
+template <typename InputIterator, typename T, typename BinaryOperation>
 T accumulate(InputIterator beg, InputIterator end, T init, BinaryOperation bi_op) {
-	for (; beg != end; ++beg)
-		init = bi_op(init, *beg);
+	if constexpr (is_segmented_iterator_v<InputIterator>) {
+		__for_each_segment(beg, end, [&](auto, auto first, auto last) {
+			init = lmstl::accumulate(first, last, init, bi_op);
+			return true;
+		});
+	}
+	else {
+		for (; beg != end; ++beg)
+			init = bi_op(init, *beg);
+	}
 	return init;
 }
-*/
+
 template <typename InputIterator, typename OutputIterator>
 OutputIterator adjacent_difference(InputIterator beg, InputIterator end, OutputIterator result) {
 	if (beg == end)
@@ -28,7 +44,7 @@ OutputIterator adjacent_difference(InputIterator beg, InputIterator end, OutputI
 	value_type cur = *beg, prev;
 	while (++beg != end) {
 		prev = *beg;
-		*(++result) = prev - value;
+		*(++result) = prev - cur;
 		cur = prev;
 	}
 	return ++result;
@@ -43,10 +59,10 @@ T inner_product(InputIterator1 beg1, InputIterator1 end1, InputIterator2 beg2, T
 
 template <typename InputIterator, typename OutputIterator>
 OutputIterator partial_sum(InputIterator beg, InputIterator end, OutputIterator result) {
-	if (beg != end)
+	if (beg == end)
 		return result;
 	*result = *beg;
-	typedef iterator_traits<InputIterator>::value_type sum = *beg;
+	typename iterator_traits<InputIterator>::value_type sum = *beg;
 	while ((++beg) != end) {
 		sum = sum + *beg;
 		*(++result) = sum;
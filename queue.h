@@ -4,6 +4,10 @@
 #include "deque.h"
 #include "vector.h"
 #include "heap_algo.h"
+#include "functional.h"
+#include "exceptdef.h"
+#include "utility.h"
+#include <stdexcept>
 
 namespace lmstl {
 
@@ -20,6 +24,12 @@ public:
 protected:
 	Sequence c;
 public:
+	queue():
+		c() {}
+	explicit queue(const Sequence& s):
+		c(s) {}
+	explicit queue(Sequence&& s):
+		c(lmstl::move(s)) {}
 	bool empty() const { return c.empty(); }
 	size_type size() const { return c.size(); }
 	reference front() { return c.front(); }
@@ -27,6 +37,7 @@ public:
 	reference back() { return c.back(); }
 	const_reference back() const { return c.back(); }
 	void push(const value_type& val) { c.push_back(val); }
+	void push(value_type&& val) { c.push_back(lmstl::move(val)); }
 	void pop() { c.pop_front(); }
 };
 
@@ -44,24 +55,254 @@ template <typename T, typename Sequence>
 bool operator<(const queue<T, Sequence>& lhs, const queue<T, Sequence>& rhs) {
 	return lhs.c < rhs.c;
 }
-/*
-template <typename T, typename Sequence = vector<T>, typename Compare = std::less<typename Sequence::value_type>>
+//Arity是堆的叉数，元素很多时用4或8树更矮，下滤经过的层数和缓存缺失更少，queue_test中有对比
+//Arity > 2时c的开头留出Arity-1个不用的位置（值类型须可默认构造），每组兄弟结点的起点都是Arity的倍数，
+//c的存储按缓存行对齐时（见dary_priority_queue）一组兄弟落在同一条缓存行内
+template <typename T, typename Sequence = vector<T>, typename Compare = less<typename Sequence::value_type>, size_t Arity = 2>
 class priority_queue {
 public:
 	typedef typename Sequence::value_type value_type;
 	typedef typename Sequence::size_type size_type;
 	typedef typename Sequence::reference reference;
 	typedef typename Sequence::const_reference const_reference;
+	typedef Sequence container_type;
+	typedef Compare value_compare;
 protected:
+	static constexpr size_t pad = Arity > 2 ? Arity - 1 : 0;
+
 	Sequence c;
 	Compare comp;
+
+	void fill_pad() {
+		if constexpr (pad != 0)
+			c.insert(c.begin(), pad, value_type());
+	}
 public:
 	priority_queue():
-		c() {}
-	explicit priority_queue(const Compare& x) :
-		c(), comp(x) {}
+		c() {
+		fill_pad();
+	}
+	explicit priority_queue(const Compare& x):
+		c(), comp(x) {
+		fill_pad();
+	}
+	priority_queue(const Compare& x, const Sequence& s):
+		c(s), comp(x) {
+		fill_pad();
+		lmstl::make_dary_heap<Arity, pad>(c.begin(), c.end(), comp);
+	}
+	priority_queue(const Compare& x, Sequence&& s):
+		c(lmstl::move(s)), comp(x) {
+		fill_pad();
+		lmstl::make_dary_heap<Arity, pad>(c.begin(), c.end(), comp);
+	}
+	template <typename InputIter, typename = typename enable_if<
+		is_input_iterator_v<InputIter>>::type>
+	priority_queue(InputIter beg, InputIter end, const Compare& x = Compare()):
+		c(beg, end), comp(x) {
+		fill_pad();
+		lmstl::make_dary_heap<Arity, pad>(c.begin(), c.end(), comp);
+	}
+
+	bool empty() const { return c.size() == pad; }
+	size_type size() const { return c.size() - pad; }
+	const_reference top() const { return *(c.begin() + pad); }
+
+	void push(const value_type& val) {
+		c.push_back(val);
+		lmstl::push_dary_heap<Arity, pad>(c.begin(), c.end(), comp);
+	}
+	void push(value_type&& val) {
+		c.push_back(lmstl::move(val));
+		lmstl::push_dary_heap<Arity, pad>(c.begin(), c.end(), comp);
+	}
+	template <typename... Args>
+	void emplace(Args&&... args) {
+		c.emplace_back(lmstl::forward<Args>(args)...);
+		lmstl::push_dary_heap<Arity, pad>(c.begin(), c.end(), comp);
+	}
+	void pop() {
+		lmstl::pop_dary_heap<Arity, pad>(c.begin(), c.end(), comp);
+		c.pop_back();
+	}
+
+	void swap(priority_queue& x) {
+		c.swap(x.c);
+		lmstl::swap(comp, x.comp);
+	}
+};
+
+//存储按缓存行对齐的d叉优先队列
+template <typename T, size_t Arity = 4, typename Compare = less<T>>
+using dary_priority_queue = priority_queue<T, vector<T, cacheline_alloc>, Compare, Arity>;
+
+//可寻址的优先队列：push返回一个句柄，之后可以按句柄在O(log n)内修改、删除元素，不必懒删除
+//堆里存值和句柄，pos[句柄]记录它在堆中的下标，元素每移动一次就更新一次；删除后句柄回收再用
+template <typename T, typename Compare = less<T>>
+class indexed_priority_queue {
+public:
+	typedef T			value_type;
+	typedef size_t		size_type;
+	typedef size_t		handle_type;
+	typedef const T&	const_reference;
+	typedef Compare		value_compare;
+
+	static constexpr size_type npos = size_type(-1);
+
+private:
+	struct node {
+		T value;
+		handle_type id;
+
+		template <typename... Args>
+		node(handle_type h, Args&&... args):
+			value(lmstl::forward<Args>(args)...), id(h) {}
+	};
+
+	vector<node> heap;
+	vector<size_type> pos;
+	vector<handle_type> free_ids;
+	Compare comp;
+
+public:
+	indexed_priority_queue() {}
+	explicit indexed_priority_queue(const Compare& x):
+		comp(x) {}
+
+	bool empty() const { return heap.empty(); }
+	size_type size() const { return heap.size(); }
+
+	const_reference top() const { return heap.front().value; }
+	handle_type top_handle() const { return heap.front().id; }
+
+	bool contains(handle_type h) const { return h < pos.size() && pos[h] != npos; }
+	const_reference value(handle_type h) const {
+		__THROW_OUT_OF_RANGE_ERROR(!contains(h), "invalid indexed_priority_queue handle");
+		return heap[pos[h]].value;
+	}
+
+	void reserve(size_type n) {
+		heap.reserve(n);
+		pos.reserve(n);
+	}
+
+	handle_type push(const value_type& val) { return emplace(val); }
+	handle_type push(value_type&& val) { return emplace(lmstl::move(val)); }
+
+	template <typename... Args>
+	handle_type emplace(Args&&... args) {
+		handle_type h;
+		if (free_ids.empty()) {
+			h = pos.size();
+			pos.push_back(npos);
+		}
+		else {
+			h = free_ids.back();
+			free_ids.pop_back();
+		}
+		try {
+			heap.emplace_back(h, lmstl::forward<Args>(args)...);
+		}
+		catch (...) {
+			free_ids.push_back(h);
+			throw;
+		}
+		pos[h] = heap.size() - 1;
+		sift_up(heap.size() - 1);
+		return h;
+	}
+
+	void pop() { erase_at(0); }
+
+	void erase(handle_type h) {
+		__THROW_OUT_OF_RANGE_ERROR(!contains(h), "invalid indexed_priority_queue handle");
+		erase_at(pos[h]);
+	}
+
+	//改成任意新值，按需要上滤或下滤
+	void update(handle_type h, const value_type& val) {
+		__THROW_OUT_OF_RANGE_ERROR(!contains(h), "invalid indexed_priority_queue handle");
+		const size_type i = pos[h];
+		const bool up = comp(heap[i].value, val);
+		heap[i].value = val;
+		if (up)
+			sift_up(i);
+		else
+			sift_down(i);
+	}
+
+	//新值不能排在原值之后（用greater得到小顶堆时就是减小键值），只需上滤
+	void decrease_key(handle_type h, const value_type& val) {
+		__THROW_OUT_OF_RANGE_ERROR(!contains(h), "invalid indexed_priority_queue handle");
+		const size_type i = pos[h];
+		heap[i].value = val;
+		sift_up(i);
+	}
+
+	void clear() {
+		heap.clear();
+		pos.clear();
+		free_ids.clear();
+	}
+
+	void swap(indexed_priority_queue& x) {
+		heap.swap(x.heap);
+		pos.swap(x.pos);
+		free_ids.swap(x.free_ids);
+		lmstl::swap(comp, x.comp);
+	}
+
+private:
+	void place(size_type i, node&& n) {
+		pos[n.id] = i;
+		heap[i] = lmstl::move(n);
+	}
+
+	void sift_up(size_type i) {
+		node tmp(lmstl::move(heap[i]));
+		while (i) {
+			const size_type parent = (i - 1) / 2;
+			if (!comp(heap[parent].value, tmp.value))
+				break;
+			place(i, lmstl::move(heap[parent]));
+			i = parent;
+		}
+		place(i, lmstl::move(tmp));
+	}
+
+	void sift_down(size_type i) {
+		const size_type len = heap.size();
+		node tmp(lmstl::move(heap[i]));
+		for (size_type child = 2 * i + 1; child < len; child = 2 * i + 1) {
+			if (child + 1 < len && comp(heap[child].value, heap[child + 1].value))
+				++child;
+			if (!comp(tmp.value, heap[child].value))
+				break;
+			place(i, lmstl::move(heap[child]));
+			i = child;
+		}
+		place(i, lmstl::move(tmp));
+	}
+
+	//用最后一个元素填补下标i，再向合适的方向调整
+	void erase_at(size_type i) {
+		const handle_type h = heap[i].id;
+		const size_type last = heap.size() - 1;
+		if (i != last) {
+			const bool up = comp(heap[i].value, heap[last].value);
+			place(i, lmstl::move(heap[last]));
+			heap.pop_back();
+			if (up)
+				sift_up(i);
+			else
+				sift_down(i);
+		}
+		else
+			heap.pop_back();
+		pos[h] = npos;
+		free_ids.push_back(h);
+	}
 };
-*/
 }
 
 #endif // !__LMSTL_QUEUE_H__
@@ -0,0 +1,806 @@
+#ifndef __LMSTL_QUEUE_TEST_H__
+#define __LMSTL_QUEUE_TEST_H__
+
+#include "test_frame.h"
+#include "queue.h"
+#include "stack.h"
+#include "ring_buffer.h"
+#include "spsc_queue.h"
+#include "mpmc_queue.h"
+#include "radix_heap.h"
+#include "timer_wheel.h"
+#include <chrono>
+#include <deque>
+#include <queue>
+#include <set>
+#include <utility>
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+namespace lmstl {
+
+template <typename Ring>
+bool ring_same(const Ring& r, const std::deque<typename Ring::value_type>& d) {
+	if (r.size() != d.size())
+		return false;
+	for (size_t i = 0; i < d.size(); ++i)
+		if (r[i] != d[i])
+			return false;
+	return true;
+}
+
+//head和tail跨过缓冲区末尾后扩容，元素顺序不变，之后还能继续回绕
+inline bool ring_buffer_wrap_reserve() {
+	ring_buffer<std::string> r(8);
+	std::deque<std::string> d;
+	for (int i = 0; i < 6; ++i) {
+		r.push_back(std::to_string(i));
+		d.push_back(std::to_string(i));
+	}
+	for (int i = 0; i < 5; ++i) {
+		r.pop_front();
+		d.pop_front();
+	}
+	for (int i = 6; i < 12; ++i) {
+		r.push_back(std::to_string(i));
+		d.push_back(std::to_string(i));
+	}
+	r.push_front("front");
+	d.push_front("front");
+	r.reserve(20);
+	if (r.capacity() != 32 || !ring_same(r, d))
+		return false;
+	for (int i = 0; i < 100; ++i) {
+		r.push_back(std::to_string(i));
+		d.push_back(std::to_string(i));
+		r.pop_front();
+		d.pop_front();
+	}
+	return ring_same(r, d);
+}
+
+//随机的两端push/pop，偶尔扩容，与std::deque比较，途中检查复制和移动
+inline bool ring_buffer_random(unsigned seed) {
+	srand(seed);
+	ring_buffer<std::string> r(16);
+	std::deque<std::string> d;
+	for (int step = 0; step < 20000; ++step) {
+		const int op = rand() % 6;
+		if (op < 2 && !r.full()) {
+			r.push_back(std::to_string(step));
+			d.push_back(std::to_string(step));
+		}
+		else if (op == 2 && !r.full()) {
+			r.emplace_front(std::to_string(-step));
+			d.push_front(std::to_string(-step));
+		}
+		else if (op == 3 && !r.empty()) {
+			r.pop_front();
+			d.pop_front();
+		}
+		else if (op == 4 && !r.empty()) {
+			r.pop_back();
+			d.pop_back();
+		}
+		else if (op == 5 && step % 500 == 0 && r.capacity() < 1024)
+			r.reserve(r.capacity() * 2);
+		if (step % 997 == 0) {
+			ring_buffer<std::string> c(r);
+			ring_buffer<std::string> m(lmstl::move(c));
+			if (!(m == r) || !c.empty() || !ring_same(m, d))
+				return false;
+		}
+	}
+	return ring_same(r, d);
+}
+
+//构造时对负数抛出异常
+struct __ring_throw {
+	int v;
+	__ring_throw(int x): v(x) {
+		if (x < 0)
+			throw std::runtime_error("negative element");
+	}
+	bool operator!=(const __ring_throw& x) const { return v != x.v; }
+};
+
+//满时push_back覆盖最旧的，push_front覆盖最新的；新元素可以引用将被覆盖的元素，构造失败时不丢元素
+inline bool ring_buffer_overwrite() {
+	ring_buffer<std::string, true> r(4);
+	std::deque<std::string> d;
+	for (int i = 0; i < 10; ++i) {
+		r.push_back(std::string(30, char('a' + i)));
+		d.push_back(std::string(30, char('a' + i)));
+		if (d.size() > 4)
+			d.pop_front();
+	}
+	if (!ring_same(r, d))
+		return false;
+	r.push_back(r.front());
+	d.push_back(d.front());
+	d.pop_front();
+	r.push_front(r.back());
+	d.push_front(d.back());
+	d.pop_back();
+	r.emplace_back(r.front());
+	d.push_back(d.front());
+	d.pop_front();
+	if (!ring_same(r, d))
+		return false;
+	ring_buffer<__ring_throw, true> t(4);
+	for (int i = 0; i < 4; ++i)
+		t.emplace_back(i);
+	int thrown = 0;
+	try {
+		t.emplace_back(-1);
+	}
+	catch (std::runtime_error&) {
+		++thrown;
+	}
+	try {
+		t.emplace_front(-1);
+	}
+	catch (std::runtime_error&) {
+		++thrown;
+	}
+	return thrown == 2 && t.size() == 4 && t.front().v == 0 && t.back().v == 3;
+}
+
+//作为queue和stack的Sequence
+inline bool ring_buffer_adapters() {
+	queue<int, ring_buffer<int>> q((ring_buffer<int>(1024)));
+	for (int i = 0; i < 1000; ++i)
+		q.push(i);
+	long sum = 0;
+	for (int expect = 0; !q.empty(); q.pop(), ++expect) {
+		if (q.front() != expect)
+			return false;
+		sum += q.front();
+	}
+	stack<std::string, ring_buffer<std::string>> st((ring_buffer<std::string>(4)));
+	st.push("1");
+	st.push("2");
+	if (st.top() != "2" || st.size() != 2)
+		return false;
+	st.pop();
+	return st.top() == "1" && sum == 999L * 1000 / 2;
+}
+
+//赋值次数用完后抛出异常的输出目标
+struct __pop_sink {
+	int v = -1;
+	static int budget;
+	__pop_sink& operator=(int x) {
+		if (budget-- == 0)
+			throw std::runtime_error("sink full");
+		v = x;
+		return *this;
+	}
+};
+
+int __pop_sink::budget = -1;
+
+//pop_n写到第三个元素时抛出异常，已经取走的两个不再留在队列里，其余元素按顺序保留
+inline bool spsc_pop_n_throw() {
+	spsc_queue<int> q(8);
+	for (int i = 1; i <= 5; ++i)
+		q.push(i);
+	__pop_sink sinks[5];
+	__pop_sink::budget = 2;
+	bool thrown = false;
+	try {
+		q.pop_n(sinks, 5);
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	__pop_sink::budget = -1;
+	if (!thrown || sinks[0].v != 1 || sinks[1].v != 2 || q.size() != 3)
+		return false;
+	int val;
+	for (int expect = 3; expect <= 5; ++expect)
+		if (!q.try_pop(val) || val != expect)
+			return false;
+	return q.empty();
+}
+
+//移动赋值在值为负时抛出异常，移动构造不抛
+struct __mpmc_throw {
+	int v;
+	__mpmc_throw(int x = 0) noexcept: v(x) {}
+	__mpmc_throw(__mpmc_throw&& x) noexcept: v(x.v) {}
+	__mpmc_throw& operator=(__mpmc_throw&& x) {
+		if (x.v < 0)
+			throw std::runtime_error("negative element");
+		v = x.v;
+		return *this;
+	}
+};
+
+//try_pop赋值给out时抛出异常，槽位照常归还，队列容量用满后仍能继续push/pop
+inline bool mpmc_pop_throw() {
+	mpmc_queue<__mpmc_throw> q(4);
+	__mpmc_throw out;
+	int thrown = 0;
+	for (int round = 0; round < 3; ++round) {
+		for (int i = 0; i < 4; ++i)
+			if (!q.try_push(__mpmc_throw(i % 2 ? -i : i)))
+				return false;
+		for (int i = 0; i < 4; ++i) {
+			try {
+				if (!q.try_pop(out) || out.v != i)
+					return false;
+			}
+			catch (std::runtime_error&) {
+				++thrown;
+			}
+		}
+	}
+	return thrown == 6 && !q.try_pop(out);
+}
+
+//逐个push_heap后仍是堆：父节点被搬到空位而不是最后一个位置
+inline bool push_heap_keeps_heap(unsigned seed) {
+	srand(seed);
+	int h[1000], g[1000];
+	for (int i = 0; i < 1000; ++i) {
+		h[i] = g[i] = rand() % 100;
+		lmstl::push_heap(h, h + i + 1);
+		lmstl::push_heap(g, g + i + 1, greater<int>());
+		if (!std::is_heap(h, h + i + 1) || !std::is_heap(g, g + i + 1, std::greater<int>()))
+			return false;
+	}
+	return true;
+}
+
+//随机push/pop（含大量相等的值），每一步的top和size都与std::priority_queue一致
+template <typename PQ, typename StdPQ>
+bool priority_queue_random(unsigned seed, int steps, int range) {
+	srand(seed);
+	PQ q;
+	StdPQ sq;
+	for (int step = 0; step < steps; ++step) {
+		if (rand() % 3 || sq.empty()) {
+			const int v = rand() % range;
+			q.push(v);
+			sq.push(v);
+		}
+		else {
+			q.pop();
+			sq.pop();
+		}
+		if (q.size() != sq.size() || (!sq.empty() && q.top() != sq.top()))
+			return false;
+	}
+	for (; !sq.empty(); q.pop(), sq.pop())
+		if (q.top() != sq.top())
+			return false;
+	return q.empty();
+}
+
+//各种长度下make_dary_heap建出的是D叉堆，dary_heap_sort排出升序；开头的Pad个位置不应被改动
+//Pad为D-1时下标p的父结点是p / D + D - 2，每组兄弟的起点是D的倍数
+template <size_t D, size_t Pad = 0>
+bool dary_heap_sorts(unsigned seed) {
+	srand(seed);
+	const int lengths[] = { 0, 1, 2, (int)D, (int)D + 1, (int)(D * D), (int)(D * D) + 1, 1000 };
+	for (int n : lengths) {
+		std::vector<int> v(Pad, -1);
+		for (int i = 0; i < n; ++i)
+			v.push_back(rand() % 50);
+		std::vector<int> w(v.begin() + Pad, v.end());
+		lmstl::make_dary_heap<D, Pad>(v.begin(), v.end());
+		for (int i = Pad + 1; i < n + (int)Pad; ++i) {
+			const int parent = Pad == D - 1 ? i / (int)D + (int)D - 2 : (i - (int)Pad - 1) / (int)D + (int)Pad;
+			if (v[parent] < v[i])
+				return false;
+		}
+		lmstl::dary_heap_sort<D, Pad>(v.begin(), v.end());
+		std::sort(w.begin(), w.end());
+		if (std::count(v.begin(), v.begin() + Pad, -1) != (int)Pad || !std::equal(w.begin(), w.end(), v.begin() + Pad))
+			return false;
+	}
+	return true;
+}
+
+//dary_priority_queue的存储从缓存行边界开始，堆顶前面是Arity-1个填充位置
+template <size_t Arity>
+bool dary_pq_aligned() {
+	dary_priority_queue<int, Arity> q;
+	std::priority_queue<int> sq;
+	bool aligned = true;
+	for (int i = 0; i < 5000; ++i) {
+		q.push(i * 7919 % 5000);
+		sq.push(i * 7919 % 5000);
+		aligned = aligned && (size_t)(&q.top() - (Arity - 1)) % __LMSTL_CACHE_LINE_SIZE == 0;
+	}
+	for (; !sq.empty(); q.pop(), sq.pop())
+		if (q.top() != sq.top())
+			return false;
+	return aligned && q.empty() && q.size() == 0;
+}
+
+//按句柄update、decrease_key、erase、pop，与std::set<(值, 句柄)>模型比较
+inline bool indexed_pq_model(unsigned seed) {
+	srand(seed);
+	indexed_priority_queue<int, greater<int>> q;
+	std::set<std::pair<int, size_t>> ref;
+	std::vector<size_t> live;
+	for (int step = 0; step < 50000; ++step) {
+		const int op = rand() % 6;
+		if (op < 2 || live.empty()) {
+			const int v = rand() % 1000;
+			const size_t h = q.push(v);
+			if (ref.count(std::make_pair(v, h)))
+				return false;
+			ref.insert(std::make_pair(v, h));
+			live.push_back(h);
+		}
+		else if (op == 2) {
+			const size_t k = rand() % live.size(), h = live[k];
+			ref.erase(std::make_pair(q.value(h), h));
+			q.erase(h);
+			if (q.contains(h))
+				return false;
+			live[k] = live.back();
+			live.pop_back();
+		}
+		else if (op == 3) {
+			const size_t h = live[rand() % live.size()];
+			const int v = rand() % 1000;
+			ref.erase(std::make_pair(q.value(h), h));
+			ref.insert(std::make_pair(v, h));
+			q.update(h, v);
+		}
+		else if (op == 4) {
+			const size_t h = live[rand() % live.size()];
+			const int v = q.value(h) - rand() % 100;
+			ref.erase(std::make_pair(q.value(h), h));
+			ref.insert(std::make_pair(v, h));
+			q.decrease_key(h, v);
+		}
+		else {
+			const size_t h = q.top_handle();
+			if (q.top() != ref.begin()->first || q.value(h) != q.top())
+				return false;
+			ref.erase(std::make_pair(q.top(), h));
+			q.pop();
+			live.erase(std::find(live.begin(), live.end(), h));
+		}
+		if (q.size() != ref.size() || (!ref.empty() && q.top() != ref.begin()->first))
+			return false;
+	}
+	return true;
+}
+
+//用已经删除的句柄抛出out_of_range，句柄回收后指向新元素
+inline bool indexed_pq_handles() {
+	indexed_priority_queue<std::string> q;
+	const size_t a = q.push("x");
+	const size_t b = q.emplace(2, 'z');
+	q.update(a, "zzz");
+	if (q.top() != "zzz")
+		return false;
+	q.erase(a);
+	if (q.top() != "zz" || q.top_handle() != b)
+		return false;
+	bool thrown = false;
+	try {
+		q.erase(a);
+	}
+	catch (std::out_of_range&) {
+		thrown = true;
+	}
+	const size_t c = q.push("y");
+	return thrown && c == a && q.value(c) == "y" && q.size() == 2;
+}
+
+//一个生产者线程把0..len-1交给一个消费者线程，消费者累加，返回耗时的毫秒数
+//多线程下clock()在各平台上含义不同，这里统一用steady_clock计墙上时间
+
+inline int queue_mutex_transfer(size_t len, unsigned long long& sum) {
+	queue<int> q;
+	std::mutex mtx;
+	auto start = std::chrono::steady_clock::now();
+	std::thread producer([&] {
+		for (size_t i = 0; i < len; ++i) {
+			std::lock_guard<std::mutex> guard(mtx);
+			q.push((int)i);
+		}
+	});
+	for (size_t got = 0; got < len; ) {
+		std::lock_guard<std::mutex> guard(mtx);
+		for (; !q.empty(); q.pop(), ++got)
+			sum += q.front();
+	}
+	producer.join();
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline int spsc_transfer(size_t len, unsigned long long& sum) {
+	spsc_queue<int> q(4096);
+	auto start = std::chrono::steady_clock::now();
+	std::thread producer([&] {
+		for (size_t i = 0; i < len; ++i)
+			q.push((int)i);
+	});
+	int val;
+	for (size_t got = 0; got < len; ++got) {
+		q.pop(val);
+		sum += val;
+	}
+	producer.join();
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline int spsc_batch_transfer(size_t len, unsigned long long& sum) {
+	const size_t batch = 64;
+	spsc_queue<int> q(4096);
+	auto start = std::chrono::steady_clock::now();
+	std::thread producer([&] {
+		int vals[batch];
+		for (size_t i = 0; i < len; ) {
+			size_t n = len - i < batch ? len - i : batch;
+			for (size_t k = 0; k < n; ++k)
+				vals[k] = (int)(i + k);
+			for (size_t done = 0; done < n; ) {
+				size_t pushed = q.push_n(vals + done, n - done);
+				if (!pushed)
+					std::this_thread::yield();
+				done += pushed;
+			}
+			i += n;
+		}
+	});
+	int vals[batch];
+	for (size_t got = 0; got < len; ) {
+		size_t n = q.pop_n(vals, batch);
+		if (!n)
+			std::this_thread::yield();
+		for (size_t k = 0; k < n; ++k)
+			sum += vals[k];
+		got += n;
+	}
+	producer.join();
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+//多生产者多消费者：QUEUE_FAN_THREADS个生产者各送出len / QUEUE_FAN_THREADS个数，同样多的消费者一起取完
+#define QUEUE_FAN_THREADS 2
+
+inline int queue_mutex_fan(size_t len, unsigned long long& sum) {
+	queue<int> q;
+	std::mutex mtx;
+	std::atomic<size_t> got(0);
+	std::atomic<unsigned long long> total(0);
+	const size_t each = len / QUEUE_FAN_THREADS;
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (size_t p = 0; p < QUEUE_FAN_THREADS; ++p)
+		threads.emplace_back([&, p] {
+			for (size_t i = p * each; i < (p + 1) * each; ++i) {
+				std::lock_guard<std::mutex> guard(mtx);
+				q.push((int)i);
+			}
+		});
+	for (size_t c = 0; c < QUEUE_FAN_THREADS; ++c)
+		threads.emplace_back([&] {
+			unsigned long long local = 0;
+			while (got.load(std::memory_order_relaxed) < each * QUEUE_FAN_THREADS) {
+				std::lock_guard<std::mutex> guard(mtx);
+				for (; !q.empty(); q.pop(), got.fetch_add(1, std::memory_order_relaxed))
+					local += q.front();
+			}
+			total += local;
+		});
+	for (size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+	sum += total;
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline int mpmc_fan(size_t len, unsigned long long& sum) {
+	mpmc_queue<int> q(4096);
+	std::atomic<size_t> got(0);
+	std::atomic<unsigned long long> total(0);
+	const size_t each = len / QUEUE_FAN_THREADS;
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (size_t p = 0; p < QUEUE_FAN_THREADS; ++p)
+		threads.emplace_back([&, p] {
+			for (size_t i = p * each; i < (p + 1) * each; ++i)
+				q.push((int)i);
+		});
+	for (size_t c = 0; c < QUEUE_FAN_THREADS; ++c)
+		threads.emplace_back([&] {
+			unsigned long long local = 0;
+			int val;
+			while (got.load(std::memory_order_relaxed) < each * QUEUE_FAN_THREADS) {
+				if (q.try_pop(val)) {
+					local += val;
+					got.fetch_add(1, std::memory_order_relaxed);
+				}
+				else
+					std::this_thread::yield();
+			}
+			total += local;
+		});
+	for (size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+	sum += total;
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+//随机push/pop，与(键, 编号)的multiset比较：top的键是最小的，且pop弹出的正是top返回的那个元素
+//maxjump控制新键比上次弹出的键大多少，很大时键跨过字和层的边界；四分之一的push与上次弹出的键相同
+template <typename Q, typename K>
+bool monotone_queue_random(unsigned seed, int steps, K maxjump) {
+	typedef typename Q::value_type value_type;
+	srand(seed);
+	Q q;
+	std::multiset<std::pair<K, int>> ref;
+	K last = 0;
+	for (int step = 0; step < steps; ++step) {
+		if (rand() % 5 < 3 || ref.empty()) {
+			const K jump = rand() % 4 ? (K)((((uint64_t)rand() << 31) ^ (uint64_t)rand()) % ((uint64_t)maxjump + 1)) : 0;
+			K k = (K)(last + jump);
+			if (k < last)
+				k = last;
+			//一半的键取64的整数倍附近，检查槽和字的边界
+			if (rand() % 2 && k - last > 64)
+				k = (K)(k & ~(K)63);
+			q.push(value_type(k, step));
+			ref.insert(std::make_pair(k, step));
+		}
+		else {
+			const value_type t = q.top();
+			typename std::multiset<std::pair<K, int>>::iterator it = ref.find(std::make_pair(t.first, t.second));
+			if (it == ref.end() || t.first != ref.begin()->first)
+				return false;
+			ref.erase(it);
+			last = t.first;
+			q.pop();
+		}
+		if (q.size() != ref.size())
+			return false;
+	}
+	for (; !ref.empty(); q.pop()) {
+		const value_type t = q.top();
+		typename std::multiset<std::pair<K, int>>::iterator it = ref.find(std::make_pair(t.first, t.second));
+		if (it == ref.end() || t.first != ref.begin()->first)
+			return false;
+		ref.erase(it);
+	}
+	return q.empty();
+}
+
+//同一个键push多个不同的元素，top和pop必须指向同一个
+template <typename Q>
+bool monotone_queue_ties() {
+	typedef typename Q::value_type value_type;
+	Q q;
+	for (int round = 0; round < 3; ++round)
+		for (int i = 0; i < 5; ++i)
+			q.push(value_type(1000 + round * 100, i));
+	std::set<std::pair<uint64_t, int>> seen;
+	while (!q.empty()) {
+		const value_type t = q.top();
+		if (!seen.insert(std::make_pair((uint64_t)t.first, t.second)).second)
+			return false;
+		q.pop();
+	}
+	return seen.size() == 15;
+}
+
+//push比上次弹出的键还小时抛出runtime_error，队列不变
+template <typename Q>
+bool monotone_queue_rejects_past() {
+	typedef typename Q::value_type value_type;
+	Q q;
+	q.push(value_type(10, 0));
+	q.push(value_type(20, 1));
+	q.pop();
+	bool thrown = false;
+	try {
+		q.push(value_type(9, 2));
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	return thrown && q.size() == 1 && q.top().first == 20;
+}
+
+typedef pair<uint64_t, int> __event64;
+typedef pair<uint32_t, int> __event32;
+typedef pair<uint16_t, int> __event16;
+
+//保持len个键：每次弹出最小的键now，再push now + rand() % 100000，共len次，最后全部弹出
+template <typename Q>
+int hold_model(size_t len) {
+	Q q;
+	srand(1);
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < len; ++i)
+		q.push((uint64_t)(rand() % 100000));
+	uint64_t now = 0;
+	for (size_t i = 0; i < len; ++i) {
+		if (q.top() < now)
+			return -1;
+		now = q.top();
+		q.pop();
+		q.push(now + rand() % 100000);
+	}
+	for (; !q.empty(); q.pop()) {
+		if (q.top() < now)
+			return -1;
+		now = q.top();
+	}
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+//len个随机的64位键先全部push再全部pop，返回耗时的毫秒数，弹出顺序不对时返回-1
+//Pad为Arity-1且Alloc为cacheline_alloc时是按缓存行对齐的布局，Pad为0时是普通的d叉堆
+template <size_t Arity, size_t Pad = 0, typename Alloc = alloc>
+int heap_push_pop(size_t len) {
+	typedef unsigned long long key;
+	vector<key, Alloc> v(Pad, 0);
+	srand(1);
+	std::vector<key> keys(len);
+	for (size_t i = 0; i < len; ++i)
+		keys[i] = ((key)rand() << 32) ^ (key)rand();
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < len; ++i) {
+		v.push_back(keys[i]);
+		lmstl::push_dary_heap<Arity, Pad>(v.begin(), v.end(), greater<key>());
+	}
+	key prev = 0;
+	for (; v.size() > Pad; v.pop_back()) {
+		if (v[Pad] < prev)
+			return -1;
+		prev = v[Pad];
+		lmstl::pop_dary_heap<Arity, Pad>(v.begin(), v.end(), greater<key>());
+	}
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+#define QUEUE_TIMING(transfer, len) do{	\
+	unsigned long long sum = 0;	\
+	int n = transfer(len, sum);	\
+	if (sum != (unsigned long long)(len) * ((len) - 1) / 2)	\
+		queue_fail = true;	\
+	std::string t = std::to_string(n);	\
+	t += "ms    |";	\
+	cout << std::setw(WIDE) << t;	\
+}while(0)
+
+#define QUEUE_PERF_TEST(name, transfer, len1, len2, len3) do{	\
+	cout << "|---------------------|-------------|-------------|-------------|\n";	\
+	std::string l1(#len1), l2(#len2), l3(#len3);	\
+	l1+="   |";l2+="   |";l3+="   |";	\
+	cout << "|" << std::setw(WIDE2) << "transfer      |";	\
+	cout<<std::setw(WIDE)<<l1<<std::setw(WIDE)<<l2<<std::setw(WIDE)<<l3<<"\n|" << name;	\
+	QUEUE_TIMING(transfer, len1);	\
+	QUEUE_TIMING(transfer, len2);	\
+	QUEUE_TIMING(transfer, len3);	\
+	cout << endl;	\
+}while(0)
+
+#define HEAP_TIMING(func, len) do{	\
+	int n = func(len);	\
+	if (n < 0)	\
+		queue_fail = true;	\
+	std::string t = std::to_string(n);	\
+	t += "ms    |";	\
+	cout << std::setw(WIDE) << t;	\
+}while(0)
+
+#define HEAP_PERF_TEST(name, func, len1, len2, len3) do{	\
+	cout << "|---------------------|-------------|-------------|-------------|\n";	\
+	std::string l1(#len1), l2(#len2), l3(#len3);	\
+	l1+="   |";l2+="   |";l3+="   |";	\
+	cout << "|" << std::setw(WIDE2) << "push + pop    |";	\
+	cout<<std::setw(WIDE)<<l1<<std::setw(WIDE)<<l2<<std::setw(WIDE)<<l3<<"\n|" << name;	\
+	HEAP_TIMING(func, len1);	\
+	HEAP_TIMING(func, len2);	\
+	HEAP_TIMING(func, len3);	\
+	cout << endl;	\
+}while(0)
+
+void queue_test() {
+	bool queue_fail = false;
+	API_TEST_START();
+	cout << "[----------------- Container test : ring_buffer ----------------]\n";
+	ring_buffer<int> mr(5);
+	std::deque<int> sr;
+	API_CHECK("ring_buffer capacity rounds up", mr.capacity() == 8 && mr.empty());
+	API_TEST01(mr, sr, push_back, 1);
+	API_TEST01(mr, sr, push_front, 2);
+	API_TEST01(mr, sr, emplace_back, 3);
+	API_TEST01(mr, sr, pop_front, );
+	API_TEST01(mr, sr, pop_back, );
+	for (int i = 0; i < 7; ++i) {
+		mr.push_back(i);
+		sr.push_back(i);
+	}
+	API_COMPARE(mr, sr);
+	API_CHECK("ring_buffer full throws", !mr.try_push_back(9) && mr.full());
+	API_CHECK("ring_buffer reserve while wrapped", ring_buffer_wrap_reserve());
+	API_CHECK("ring_buffer random operations", ring_buffer_random(1) && ring_buffer_random(2));
+	API_CHECK("ring_buffer overwrite mode", ring_buffer_overwrite());
+	API_CHECK("ring_buffer as queue and stack Sequence", ring_buffer_adapters());
+	cout << "[----------------- Container test : spsc_queue -----------------]\n";
+	API_CHECK("spsc_queue pop_n keeps the rest when an assignment throws", spsc_pop_n_throw());
+	cout << "[----------------- Container test : mpmc_queue -----------------]\n";
+	API_CHECK("mpmc_queue try_pop releases the slot when an assignment throws", mpmc_pop_throw());
+	cout << "[--------------- Container test : priority_queue ---------------]\n";
+	API_CHECK("push_heap keeps the heap property", push_heap_keeps_heap(1) && push_heap_keeps_heap(2));
+	API_CHECK("priority_queue against std::priority_queue",
+		(priority_queue_random<priority_queue<int>, std::priority_queue<int>>(1, 100000, 1000)));
+	API_CHECK("priority_queue with many equal values",
+		(priority_queue_random<priority_queue<int>, std::priority_queue<int>>(2, 20000, 5)));
+	API_CHECK("priority_queue with greater",
+		(priority_queue_random<priority_queue<int, vector<int>, greater<int>>, std::priority_queue<int, std::vector<int>, std::greater<int>>>(3, 20000, 1000)));
+	API_CHECK("make_dary_heap and dary_heap_sort", dary_heap_sorts<3>(1) && dary_heap_sorts<4>(2) && dary_heap_sorts<8>(3));
+	API_CHECK("padded d-ary heap layout", (dary_heap_sorts<3, 2>(4) && dary_heap_sorts<4, 3>(5) && dary_heap_sorts<8, 7>(6) && dary_heap_sorts<4, 1>(7)));
+	API_CHECK("dary_priority_queue storage is cache-line aligned", dary_pq_aligned<4>() && dary_pq_aligned<8>() && dary_pq_aligned<16>());
+	API_CHECK("4-ary priority_queue against std::priority_queue",
+		(priority_queue_random<priority_queue<int, vector<int>, less<int>, 4>, std::priority_queue<int>>(4, 50000, 100)));
+	API_CHECK("8-ary priority_queue with greater",
+		(priority_queue_random<priority_queue<int, vector<int>, greater<int>, 8>, std::priority_queue<int, std::vector<int>, std::greater<int>>>(5, 50000, 100)));
+	API_CHECK("indexed_priority_queue against a reference model", indexed_pq_model(1) && indexed_pq_model(2));
+	API_CHECK("indexed_priority_queue handles", indexed_pq_handles());
+	cout << "[---------------- Container test : radix_heap -----------------]\n";
+	API_CHECK("radix_heap with small steps",
+		(monotone_queue_random<radix_heap<__event64, select1st<__event64>>, uint64_t>(1, 50000, 1000)));
+	API_CHECK("radix_heap across all key bits",
+		(monotone_queue_random<radix_heap<__event64, select1st<__event64>>, uint64_t>(2, 50000, uint64_t(-1) / 4)));
+	API_CHECK("radix_heap on 32-bit keys",
+		(monotone_queue_random<radix_heap<__event32, select1st<__event32>>, uint32_t>(3, 50000, 100000)));
+	API_CHECK("radix_heap top and pop agree on ties", (monotone_queue_ties<radix_heap<__event64, select1st<__event64>>>()));
+	API_CHECK("radix_heap rejects keys before last_key()", (monotone_queue_rejects_past<radix_heap<__event64, select1st<__event64>>>()));
+	cout << "[---------------- Container test : timer_wheel ----------------]\n";
+	API_CHECK("timer_wheel with small steps",
+		(monotone_queue_random<timer_wheel<__event64, select1st<__event64>>, uint64_t>(4, 50000, 1000)));
+	API_CHECK("timer_wheel across all levels",
+		(monotone_queue_random<timer_wheel<__event64, select1st<__event64>>, uint64_t>(5, 50000, uint64_t(-1) / 4)));
+	API_CHECK("timer_wheel with 16 slots per level",
+		(monotone_queue_random<timer_wheel<__event32, select1st<__event32>, 4>, uint32_t>(6, 50000, 100000)));
+	API_CHECK("timer_wheel with 8 slots and 16-bit keys",
+		(monotone_queue_random<timer_wheel<__event16, select1st<__event16>, 3>, uint16_t>(7, 20000, 30)));
+	API_CHECK("timer_wheel top and pop agree on ties", (monotone_queue_ties<timer_wheel<__event64, select1st<__event64>>>()));
+	API_CHECK("timer_wheel rejects times before now()", (monotone_queue_rejects_past<timer_wheel<__event64, select1st<__event64>>>()));
+	API_TEST_END();
+	PERF_TEST_START();
+	cout << "[------------------ Container test : queue ---------------------]\n";
+	QUEUE_PERF_TEST("   mutex + queue     |", queue_mutex_transfer, 100000, 1000000, 10000000);
+	QUEUE_PERF_TEST("     spsc_queue      |", spsc_transfer, 100000, 1000000, 10000000);
+	QUEUE_PERF_TEST("  spsc_queue batch   |", spsc_batch_transfer, 100000, 1000000, 10000000);
+	QUEUE_PERF_TEST(" 2x2 mutex + queue   |", queue_mutex_fan, 100000, 1000000, 10000000);
+	QUEUE_PERF_TEST("   2x2 mpmc_queue    |", mpmc_fan, 100000, 1000000, 10000000);
+	cout << "[--------------- Container test : priority_queue ---------------]\n";
+	HEAP_PERF_TEST("    binary heap      |", heap_push_pop<2>, 100000, 1000000, 4000000);
+	HEAP_PERF_TEST("     4-ary heap      |", heap_push_pop<4>, 100000, 1000000, 4000000);
+	HEAP_PERF_TEST("  4-ary aligned heap |", (heap_push_pop<4, 3, cacheline_alloc>), 100000, 1000000, 4000000);
+	HEAP_PERF_TEST("     8-ary heap      |", heap_push_pop<8>, 100000, 1000000, 4000000);
+	HEAP_PERF_TEST("  8-ary aligned heap |", (heap_push_pop<8, 7, cacheline_alloc>), 100000, 1000000, 4000000);
+	cout << "[------------------ hold model : pop min, push -----------------]\n";
+	HEAP_PERF_TEST("    binary heap      |", (hold_model<priority_queue<uint64_t, vector<uint64_t>, greater<uint64_t>>>), 100000, 1000000, 4000000);
+	HEAP_PERF_TEST("     4-ary heap      |", (hold_model<priority_queue<uint64_t, vector<uint64_t>, greater<uint64_t>, 4>>), 100000, 1000000, 4000000);
+	HEAP_PERF_TEST("  4-ary aligned heap |", (hold_model<dary_priority_queue<uint64_t, 4, greater<uint64_t>>>), 100000, 1000000, 4000000);
+	HEAP_PERF_TEST("     radix_heap      |", hold_model<radix_heap<uint64_t>>, 100000, 1000000, 4000000);
+	HEAP_PERF_TEST("     timer_wheel     |", hold_model<timer_wheel<uint64_t>>, 100000, 1000000, 4000000);
+	if (queue_fail)
+		cout << RED << "FAIL" << CYAN << endl;
+	else
+		PERF_TEST_END();
+}
+
+}
+#endif // !__LMSTL_QUEUE_TEST_H__
@@ -0,0 +1,149 @@
+#ifndef __LMSTL_RADIX_HEAP_H__
+#define __LMSTL_RADIX_HEAP_H__
+
+#include "alloc.h"
+#include "vector.h"
+#include "bit_vector.h"
+#include "functional.h"
+#include "exceptdef.h"
+#include "utility.h"
+#include <stdexcept>
+#include <type_traits>
+#include <stddef.h>
+
+namespace lmstl {
+
+//单调的小顶堆：键是无符号整数，push的键不能小于最后一次pop出的键（事件调度中的时间戳满足这个条件）
+//last是最后一次pop出的键，键k放在第bit_width(k ^ last)个桶里，0号桶里的键都等于last
+//0号桶空时取最低的非空桶，把其中的最小键作为新的last并重新分桶，元素只会往更低的桶移动，
+//每个元素最多移动键的位数次，push/pop均摊O(1)，不做元素间的比较
+template <typename T, typename KeyOfValue = identity<T>, typename Alloc = alloc>
+class radix_heap {
+public:
+	typedef T					value_type;
+	typedef const T&			const_reference;
+	typedef size_t				size_type;
+	typedef KeyOfValue			key_extractor;
+	typedef typename std::decay<decltype(KeyOfValue()(std::declval<const T&>()))>::type key_type;
+
+	static_assert(std::is_unsigned<key_type>::value && sizeof(key_type) <= sizeof(bit_word),
+		"radix_heap needs an unsigned integer key of at most 64 bits");
+
+	static constexpr size_type bucket_count = sizeof(key_type) * 8 + 1;
+
+private:
+	typedef vector<T, Alloc> bucket;
+	static constexpr size_type npos = size_type(-1);
+
+	bucket buckets[bucket_count];
+	bucket scratch;
+	bit_word nonempty;		//第i位对应buckets[i + 1]
+	key_type last;
+	size_type count;
+	KeyOfValue key;
+
+	//最低非空桶中最小元素的位置，top和pop共用，npos表示需要重新扫描
+	mutable size_type min_bucket;
+	mutable size_type min_pos;
+
+public:
+	radix_heap():
+		nonempty(0), last(0), count(0), min_bucket(0), min_pos(npos) {}
+	explicit radix_heap(const KeyOfValue& k):
+		nonempty(0), last(0), count(0), key(k), min_bucket(0), min_pos(npos) {}
+
+	bool empty() const { return count == 0; }
+	size_type size() const { return count; }
+	//最后一次pop出的键，之后push的键不能比它小
+	key_type last_key() const { return last; }
+
+	const_reference top() const {
+		if (!buckets[0].empty())
+			return buckets[0].back();
+		locate_min();
+		return buckets[min_bucket][min_pos];
+	}
+
+	void push(const value_type& val) { put(val); }
+	void push(value_type&& val) { put(lmstl::move(val)); }
+	template <typename... Args>
+	void emplace(Args&&... args) { put(value_type(lmstl::forward<Args>(args)...)); }
+
+	void pop() {
+		__THROW_RUNTIME_ERROR(empty(), "pop on empty radix_heap");
+		if (buckets[0].empty())
+			redistribute();
+		buckets[0].pop_back();
+		--count;
+	}
+
+	void clear() {
+		for (size_type i = 0; i != bucket_count; ++i)
+			buckets[i].clear();
+		nonempty = 0;
+		last = 0;
+		count = 0;
+		min_pos = npos;
+	}
+
+private:
+	size_type bucket_of(key_type k) const {
+		return k == last ? 0 : __highest_bit(bit_word(k ^ last)) + 1;
+	}
+
+	template <typename U>
+	void put(U&& val) {
+		const key_type k = key(val);
+		__THROW_RUNTIME_ERROR(k < last, "radix_heap key is smaller than the last popped key");
+		const size_type i = bucket_of(k);
+		buckets[i].push_back(lmstl::forward<U>(val));
+		++count;
+		if (!i)
+			return;
+		nonempty |= bit_word(1) << (i - 1);
+		if (min_pos != npos) {
+			if (i < min_bucket)
+				min_pos = npos;
+			else if (i == min_bucket && k < key(buckets[i][min_pos]))
+				min_pos = buckets[i].size() - 1;
+		}
+	}
+
+	void locate_min() const {
+		const size_type b = __lowest_bit(nonempty) + 1;
+		if (min_pos != npos && min_bucket == b)
+			return;
+		const bucket& bk = buckets[b];
+		size_type pos = 0;
+		for (size_type i = 1; i < bk.size(); ++i)
+			if (key(bk[i]) < key(bk[pos]))
+				pos = i;
+		min_bucket = b;
+		min_pos = pos;
+	}
+
+	//0号桶为空时调用：最低非空桶的最小键成为新的last，桶里的元素按新的last分到更低的桶
+	//top()给出的最小元素最后放进0号桶，键相等时pop弹出的就是top()返回的那个
+	void redistribute() {
+		locate_min();
+		const size_type b = min_bucket;
+		const size_type m = min_pos;
+		last = key(buckets[b][m]);
+		min_pos = npos;
+		scratch.swap(buckets[b]);
+		nonempty &= ~(bit_word(1) << (b - 1));
+		for (size_type i = 0; i != scratch.size(); ++i) {
+			if (i == m)
+				continue;
+			const size_type j = bucket_of(key(scratch[i]));
+			buckets[j].push_back(lmstl::move(scratch[i]));
+			if (j)
+				nonempty |= bit_word(1) << (j - 1);
+		}
+		buckets[0].push_back(lmstl::move(scratch[m]));
+		scratch.clear();
+	}
+};
+
+}
+#endif // !__LMSTL_RADIX_HEAP_H__
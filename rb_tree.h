@@ -133,7 +133,7 @@ struct rb_tree_iterator : public rb_tree_iterator_base {
 		return tmp;
 	}
 
-	reference operator*() const { return ((node_ptr&)node)->value; }
+	reference operator*() const { return static_cast<node_ptr>(node)->value; }
 	pointer operator->() const { return &(operator*()); }
 
 	rb_tree_iterator() {}
@@ -342,7 +342,7 @@ inline rb_tree_node_base *rb_tree_erase_and_rebalance(rb_tree_node_base* x, rb_t
 }
 
 template <typename Key, typename Value, typename KeyOfValue, typename Compare, typename Alloc = alloc>
-class rb_tree {
+class rb_tree : private alloc_holder<Alloc> {
 public:
 	typedef Key key_type;
 	typedef Value value_type;
@@ -356,24 +356,26 @@ public:
 
 	typedef rb_tree_iterator<value_type, reference, pointer> iterator;
 	typedef rb_tree_iterator<value_type, const_reference, const_pointer> const_iterator;
+	typedef Alloc allocator_type;
 
 protected:
+	typedef alloc_holder<Alloc> alloc_base;
 	typedef rb_tree_node_base* base_ptr;
 	typedef rb_tree_node<value_type>* node_ptr;
 	typedef rb_tree_node<value_type> rb_tree_node;
 	typedef simple_alloc<rb_tree_node, Alloc> node_allocator;
 	
-	node_ptr get_node() { return node_allocator::allocate(1); }
-	void put_node(node_ptr p) { return node_allocator::deallocate(p, 1); }
+	node_ptr get_node() { return node_allocator::allocate(this->get_alloc(), 1); }
+	void put_node(node_ptr p) { return node_allocator::deallocate(this->get_alloc(), p, 1); }
 
 	template <typename ...Args>
 	node_ptr create_node(Args&&... args) {
-		node_ptr ret = node_allocator::allocate(1);
+		node_ptr ret = get_node();
 		try {
 			construct(&ret->value, lmstl::forward<Args>(args)...);
 		}
 		catch (...) {
-			node_allocator::deallocate(ret, 1);
+			put_node(ret);
 			__THROW_RUNTIME_ERROR(1, "Error when creating node");
 		}
 		return ret;
@@ -444,40 +446,71 @@ protected:
 		}
 	}
 
+	void copy_from(const rb_tree& x) {
+		if (!x.root())
+			return;
+		node_ptr root = _copy(x.root(), header);
+		header->parent = root;
+		header->left = rb_tree_node_base::minimum(root);
+		header->right = rb_tree_node_base::maximum(root);
+		node_count = x.node_count;
+	}
+
 public:
-	rb_tree(const Compare &comp = Compare()):
-		node_count(0), key_compare(comp) {
+	rb_tree(const Compare &comp = Compare(), const Alloc& a = Alloc()):
+		alloc_base(a), node_count(0), key_compare(comp) {
 		init();
 	}
 	
+	//先建自己的header再交换，被移动的树仍是可以继续使用的空树
 	rb_tree(rb_tree&& x):
-		header(lmstl::move(x.header)), node_count(lmstl::move(x.node_count)) {}
+		alloc_base(x.get_alloc()), node_count(0), key_compare(x.key_compare) {
+		init();
+		swap(x);
+	}
 
 	~rb_tree() {
-		erase_since(root());
-		destroy_node(header);
+		if (header) {
+			erase_since(root());
+			destroy_node(header);
+		}
 	}
 
 	rb_tree(const rb_tree& x) :
-		node_count(x.node_count) {
-		erase_since(root());
-		node_ptr root = _copy(x.root(), header);
-		header->parent = root;
-		header->left = rb_tree_node_base::minimum(root);
-		header->right = rb_tree_node_base::maximum(root);
+		alloc_base(x.get_alloc()), node_count(0), key_compare(x.key_compare) {
+		init();
+		copy_from(x);
 	}
 
 	rb_tree& operator=(const rb_tree& x) {
-		erase_since(root());
-		node_ptr root = _copy(x.root(), header);
-		node_count = x.node_count;
-		header->parent = root;
-		header->left = rb_tree_node_base::minimum(root);
-		header->right = rb_tree_node_base::maximum(root);
+		if (this != &x) {
+			if (header)
+				clear();
+			else
+				init();
+			copy_from(x);
+			key_compare = x.key_compare;
+		}
+		return *this;
+	}
+
+	rb_tree& operator=(rb_tree&& x) {
+		swap(x);
 		return *this;
 	}
 
+	void swap(rb_tree& x) {
+		lmstl::swap(header, x.header);
+		lmstl::swap(node_count, x.node_count);
+		lmstl::swap(key_compare, x.key_compare);
+		this->swap_alloc(x);
+	}
+
+	allocator_type get_allocator() const { return this->get_alloc(); }
+
 	void clear() {
+		if (!header)
+			return;
 		erase_since(root());
 		header->parent = 0;
 		header->left = header->right = header;
@@ -695,6 +728,7 @@ public:
 		}
 		if (key_compare(key(tmp.node), KeyOfValue()(add->value)))
 			return pair<iterator, bool>(__insert_node_at(prev, add), true);
+		destroy_node(add);
 		return pair<iterator, bool>(tmp, false);
 	}
 	
@@ -717,6 +751,7 @@ public:
 		}
 		if (key_compare(key(tmp.node), KeyOfValue()(add->value)))
 			return pair<iterator, bool>(__insert_node_at(prev, add), true);
+		destroy_node(add);
 		return pair<iterator, bool>(tmp, false);
 	}
 
@@ -726,7 +761,95 @@ public:
 			insert_unique(*beg);
 	}
 
+	//用[beg, end)替换树中原有内容，序列已按key有序（unique时严格递增）时O(n)直接建成平衡树，否则退回逐个插入
+	template <typename ForwardIterator>
+	void assign_sorted_unique(ForwardIterator beg, ForwardIterator end) {
+		__assign_sorted(beg, end, true);
+	}
+
+	template <typename ForwardIterator>
+	void assign_sorted_equal(ForwardIterator beg, ForwardIterator end) {
+		__assign_sorted(beg, end, false);
+	}
+
 private:
+	template <typename ForwardIterator>
+	void __assign_sorted(ForwardIterator beg, ForwardIterator end, bool unique) {
+		if (!header)
+			init();
+		size_type n = 0;
+		if (beg != end) {
+			ForwardIterator prev = beg, it = beg;
+			for (++it, n = 1; it != end; prev = it, ++it, ++n) {
+				if (unique ? !key_compare(KeyOfValue()(*prev), KeyOfValue()(*it)) : key_compare(KeyOfValue()(*it), KeyOfValue()(*prev))) {
+					clear();
+					if (unique)
+						insert_unique(beg, end);
+					else
+						insert_equal(beg, end);
+					return;
+				}
+			}
+		}
+		if (!n) {
+			clear();
+			return;
+		}
+		size_type depth = 0;
+		for (size_type m = n; m > 1; m >>= 1)
+			++depth;
+		//新树建好之前不动原有的树；建树中途抛出异常时__build_sorted已释放建好的节点，node_count回到0
+		const size_type old_count = node_count;
+		node_count = 0;
+		node_ptr r;
+		try {
+			r = __build_sorted(beg, n, header, 0, depth);
+		}
+		catch (...) {
+			node_count = old_count;
+			throw;
+		}
+		node_count = old_count;
+		clear();
+		node_count = n;
+		header->parent = r;
+		header->left = rb_tree_node_base::minimum(r);
+		header->right = rb_tree_node_base::maximum(r);
+	}
+
+	//按中序取n个元素建成左右子树大小至多差1的树，只有最深一层(red_depth)不满，把这一层染红即满足红黑性质
+	template <typename ForwardIterator>
+	node_ptr __build_sorted(ForwardIterator& it, size_type n, base_ptr p, size_type depth, size_type red_depth) {
+		if (!n)
+			return 0;
+		const size_type ln = (n - 1) / 2;
+		node_ptr left = __build_sorted(it, ln, 0, depth + 1, red_depth);
+		node_ptr x;
+		try {
+			x = create_node(*it);
+		}
+		catch (...) {
+			erase_since(left);
+			throw;
+		}
+		++it;
+		++node_count;
+		x->parent = p;
+		x->left = left;
+		x->right = 0;
+		x->color = (depth && depth == red_depth) ? rb_red : rb_black;
+		if (left)
+			left->parent = x;
+		try {
+			x->right = __build_sorted(it, n - 1 - ln, x, depth + 1, red_depth);
+		}
+		catch (...) {
+			erase_since(x);
+			throw;
+		}
+		return x;
+	}
+
 	iterator __insert(base_ptr pos_, const value_type& val) {
 		node_ptr pos = (node_ptr&)pos_;
 		node_ptr tar = create_node(val);
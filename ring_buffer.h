@@ -0,0 +1,323 @@
+#ifndef __LMSTL_RING_BUFFER_H__
+#define __LMSTL_RING_BUFFER_H__
+
+#include "alloc.h"
+#include "iterator.h"
+#include "construct.h"
+#include "uninitialized.h"
+#include "algobase.h"
+#include "exceptdef.h"
+#include "type_traits.h"
+#include "utility.h"
+#include <new>
+#include <stdexcept>
+#include <stddef.h>
+
+namespace lmstl {
+
+//ring_buffer的迭代器记下逻辑位置，解引用时与mask相与得到槽位
+template <typename T, typename Ref, typename Ptr>
+struct ring_iterator {
+	typedef random_access_iterator_tag	iterator_category;
+	typedef T							value_type;
+	typedef Ptr							pointer;
+	typedef Ref							reference;
+	typedef ptrdiff_t					difference_type;
+	typedef ring_iterator<T, Ref, Ptr>	self;
+
+	T* buf;
+	size_t mask;
+	size_t pos;
+
+	ring_iterator():
+		buf(0), mask(0), pos(0) {}
+	ring_iterator(T* b, size_t m, size_t p):
+		buf(b), mask(m), pos(p) {}
+	ring_iterator(const ring_iterator<T, T&, T*>& x):
+		buf(x.buf), mask(x.mask), pos(x.pos) {}
+
+	reference operator*() const { return buf[pos & mask]; }
+	pointer operator->() const { return buf + (pos & mask); }
+	reference operator[](difference_type n) const { return buf[(pos + n) & mask]; }
+
+	self& operator++() { ++pos; return *this; }
+	self operator++(int) { self tmp = *this; ++pos; return tmp; }
+	self& operator--() { --pos; return *this; }
+	self operator--(int) { self tmp = *this; --pos; return tmp; }
+	self& operator+=(difference_type n) { pos += n; return *this; }
+	self& operator-=(difference_type n) { pos -= n; return *this; }
+	self operator+(difference_type n) const { return self(buf, mask, pos + n); }
+	self operator-(difference_type n) const { return self(buf, mask, pos - n); }
+	difference_type operator-(const self& x) const { return difference_type(pos - x.pos); }
+
+	bool operator==(const self& x) const { return pos == x.pos; }
+	bool operator!=(const self& x) const { return pos != x.pos; }
+	bool operator<(const self& x) const { return difference_type(pos - x.pos) < 0; }
+	bool operator>(const self& x) const { return x < *this; }
+	bool operator<=(const self& x) const { return !(x < *this); }
+	bool operator>=(const self& x) const { return !(*this < x); }
+};
+
+//容量固定的环形缓冲区，只有一块连续内存，可以作为queue和stack的Sequence
+//容量向上取整为2的幂，head和tail是只增不减的计数，下标用tail & (capacity - 1)算出，push/pop没有回绕分支
+//Overwrite为false时满了再push抛出异常；为true时push_back覆盖最旧的元素，push_front覆盖最新的元素
+template <typename T, bool Overwrite = false, typename Alloc = alloc>
+class ring_buffer : private alloc_holder<Alloc> {
+public:
+	typedef T			value_type;
+	typedef T*			pointer;
+	typedef const T*	const_pointer;
+	typedef T&			reference;
+	typedef const T&	const_reference;
+	typedef size_t		size_type;
+	typedef ptrdiff_t	difference_type;
+
+	typedef ring_iterator<T, T&, T*> iterator;
+	typedef ring_iterator<T, const T&, const T*> const_iterator;
+	typedef reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef reverse_iterator<iterator> reverse_iterator;
+	typedef Alloc		allocator_type;
+
+	static const bool overwrite = Overwrite;
+
+private:
+	typedef simple_alloc<value_type, Alloc> data_allocator;
+	typedef alloc_holder<Alloc> alloc_base;
+
+	pointer buf;
+	size_type cap;
+	size_type head;
+	size_type tail;
+
+public:
+	ring_buffer():
+		buf(0), cap(0), head(0), tail(0) {}
+	explicit ring_buffer(const Alloc& a):
+		alloc_base(a), buf(0), cap(0), head(0), tail(0) {}
+	explicit ring_buffer(size_type n, const Alloc& a = Alloc()):
+		ring_buffer(a) {
+		reserve(n);
+	}
+	ring_buffer(const ring_buffer& x):
+		ring_buffer(x.get_alloc()) {
+		reserve(x.cap);
+		for (const_iterator it = x.begin(); it != x.end(); ++it)
+			emplace_back(*it);
+	}
+	ring_buffer(ring_buffer&& x) noexcept :
+		alloc_base(lmstl::move(x.get_alloc())), buf(x.buf), cap(x.cap), head(x.head), tail(x.tail) {
+		x.buf = 0;
+		x.cap = x.head = x.tail = 0;
+	}
+
+	~ring_buffer() {
+		clear();
+		data_allocator::deallocate(this->get_alloc(), buf, cap);
+	}
+
+	ring_buffer& operator=(const ring_buffer& x) {
+		if (this != &x) {
+			ring_buffer tmp(x);
+			swap(tmp);
+		}
+		return *this;
+	}
+	ring_buffer& operator=(ring_buffer&& x) noexcept {
+		if (this != &x) {
+			ring_buffer tmp(lmstl::move(x));
+			swap(tmp);
+		}
+		return *this;
+	}
+
+	allocator_type get_allocator() const { return this->get_alloc(); }
+
+public:
+
+	iterator begin() noexcept { return iterator(buf, cap - 1, head); }
+	const_iterator begin() const noexcept { return const_iterator(buf, cap - 1, head); }
+	const_iterator cbegin() const noexcept { return begin(); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+	iterator end() noexcept { return iterator(buf, cap - 1, tail); }
+	const_iterator end() const noexcept { return const_iterator(buf, cap - 1, tail); }
+	const_iterator cend() const noexcept { return end(); }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+	size_type size() const noexcept { return tail - head; }
+	size_type capacity() const noexcept { return cap; }
+	size_type max_size() const noexcept { return cap; }
+	bool empty() const noexcept { return tail == head; }
+	bool full() const noexcept { return tail - head == cap; }
+
+	reference operator[](size_type n) {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return slot(head + n);
+	}
+	const_reference operator[](size_type n) const {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return slot(head + n);
+	}
+
+	reference at(size_type n) {
+		__THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return slot(head + n);
+	}
+	const_reference at(size_type n) const {
+		__THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return slot(head + n);
+	}
+
+	reference front() noexcept { return slot(head); }
+	const_reference front() const noexcept { return slot(head); }
+	reference back() noexcept { return slot(tail - 1); }
+	const_reference back() const noexcept { return slot(tail - 1); }
+
+	void push_back(const value_type& val) { emplace_back(val); }
+	void push_back(value_type&& val) { emplace_back(lmstl::move(val)); }
+	void push_front(const value_type& val) { emplace_front(val); }
+	void push_front(value_type&& val) { emplace_front(lmstl::move(val)); }
+
+	//覆盖时先构造好新元素再移走旧元素：参数可能引用被覆盖的元素，构造抛出异常时缓冲区不变
+	template <typename... Args>
+	reference emplace_back(Args&&... args) {
+		if (full()) {
+			check_overwrite();
+			return overwrite_back(value_type(lmstl::forward<Args>(args)...));
+		}
+		pointer p = &slot(tail);
+		new((void*)p) T(lmstl::forward<Args>(args)...);
+		++tail;
+		return *p;
+	}
+
+	template <typename... Args>
+	reference emplace_front(Args&&... args) {
+		if (full()) {
+			check_overwrite();
+			return overwrite_front(value_type(lmstl::forward<Args>(args)...));
+		}
+		pointer p = &slot(head - 1);
+		new((void*)p) T(lmstl::forward<Args>(args)...);
+		--head;
+		return *p;
+	}
+
+	//满时不抛异常也不覆盖，返回false
+	bool try_push_back(const value_type& val) {
+		if (full())
+			return false;
+		new((void*)&slot(tail)) T(val);
+		++tail;
+		return true;
+	}
+	bool try_push_back(value_type&& val) {
+		if (full())
+			return false;
+		new((void*)&slot(tail)) T(lmstl::move(val));
+		++tail;
+		return true;
+	}
+
+	void pop_front() {
+		__THROW_RUNTIME_ERROR(empty(), "pop_front on empty ring_buffer");
+		destroy(&slot(head));
+		++head;
+	}
+	void pop_back() {
+		__THROW_RUNTIME_ERROR(empty(), "pop_back on empty ring_buffer");
+		--tail;
+		destroy(&slot(tail));
+	}
+
+	void clear() {
+		if (!std::is_trivially_destructible<T>::value) {
+			for (; head != tail; ++head)
+				destroy(&slot(head));
+		}
+		head = tail = 0;
+	}
+
+	//容量只在这里改变，元素按顺序搬到新缓冲区的开头
+	void reserve(size_type n) {
+		if (n <= cap)
+			return;
+		size_type new_cap = 1;
+		while (new_cap < n)
+			new_cap <<= 1;
+		pointer new_buf = data_allocator::allocate(this->get_alloc(), new_cap);
+		const size_type n_elems = size();
+		if (n_elems) {
+			pointer first = &slot(head);
+			pointer last = &slot(tail - 1) + 1;
+			if (first < last)
+				uninitialized_relocate(first, last, new_buf);
+			else
+				uninitialized_relocate(buf, last, uninitialized_relocate(first, buf + cap, new_buf));
+		}
+		data_allocator::deallocate(this->get_alloc(), buf, cap);
+		buf = new_buf;
+		cap = new_cap;
+		head = 0;
+		tail = n_elems;
+	}
+
+	void swap(ring_buffer& x) {
+		lmstl::swap(buf, x.buf);
+		lmstl::swap(cap, x.cap);
+		lmstl::swap(head, x.head);
+		lmstl::swap(tail, x.tail);
+		this->swap_alloc(x);
+	}
+
+private:
+	reference slot(size_type pos) { return buf[pos & (cap - 1)]; }
+	const_reference slot(size_type pos) const { return buf[pos & (cap - 1)]; }
+
+	void check_overwrite() const {
+		__THROW_OUT_OF_RANGE_ERROR(!Overwrite || !cap, "ring_buffer capacity exceeded");
+	}
+
+	//满时最旧的元素和新元素占同一个槽
+	reference overwrite_back(value_type&& val) {
+		pointer p = &slot(head);
+		destroy(p);
+		++head;
+		new((void*)p) T(lmstl::move(val));
+		++tail;
+		return *p;
+	}
+	reference overwrite_front(value_type&& val) {
+		pointer p = &slot(tail - 1);
+		destroy(p);
+		--tail;
+		new((void*)p) T(lmstl::move(val));
+		--head;
+		return *p;
+	}
+};
+
+template <typename T, bool Overwrite, typename Alloc>
+inline bool operator==(const ring_buffer<T, Overwrite, Alloc>& lhs, const ring_buffer<T, Overwrite, Alloc>& rhs) {
+	return lhs.size() == rhs.size() && lmstl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename T, bool Overwrite, typename Alloc>
+inline bool operator!=(const ring_buffer<T, Overwrite, Alloc>& lhs, const ring_buffer<T, Overwrite, Alloc>& rhs) {
+	return !(lhs == rhs);
+}
+
+template <typename T, bool Overwrite, typename Alloc>
+inline bool operator<(const ring_buffer<T, Overwrite, Alloc>& lhs, const ring_buffer<T, Overwrite, Alloc>& rhs) {
+	return lmstl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, bool Overwrite, typename Alloc>
+inline void swap(ring_buffer<T, Overwrite, Alloc>& lhs, ring_buffer<T, Overwrite, Alloc>& rhs) {
+	lhs.swap(rhs);
+}
+
+}
+#endif // !__LMSTL_RING_BUFFER_H__
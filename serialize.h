@@ -0,0 +1,320 @@
+#ifndef __LMSTL_SERIALIZE_H__
+#define __LMSTL_SERIALIZE_H__
+
+#include "vector.h"
+#include "deque.h"
+#include "list.h"
+#include "set.h"
+#include "map.h"
+#include "hashtable.h"
+#include "utility.h"
+#include "type_traits.h"
+#include "exceptdef.h"
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+namespace lmstl {
+
+template <typename Key, typename T, typename HashFcn, typename EqualKey, typename Alloc>
+class unordered_map;
+template <typename Value, typename HashFcn, typename EqualKey, typename Alloc>
+class unordered_set;
+
+//二进制序列化：serializer<T>负责一种类型的write/read，自定义类型可以自行特化
+//可平凡复制的值按内存表示原样读写，容器先写uint64_t的元素个数再写元素
+//格式依赖本机字节序和类型布局，只适合同一平台上的快照
+template <typename T, typename = void>
+struct serializer;
+
+template <typename T>
+inline void serialize(std::ostream& out, const T& x) {
+	serializer<T>::write(out, x);
+}
+
+template <typename T>
+inline void deserialize(std::istream& in, T& x) {
+	serializer<T>::read(in, x);
+}
+
+static const size_t __SERIALIZE_BUF_SIZE = 4096;
+//流中读出的元素个数不可信，容器每次最多按这么多字节增长，流提前结束时不会先按个数分配巨大的空间
+static const size_t __SERIALIZE_CHUNK_BYTES = 1024 * 1024;
+
+template <typename T>
+constexpr size_t __serialize_chunk() {
+	return sizeof(T) < __SERIALIZE_CHUNK_BYTES ? __SERIALIZE_CHUNK_BYTES / sizeof(T) : 1;
+}
+
+inline void __write_bytes(std::ostream& out, const void* p, size_t n) {
+	out.write(static_cast<const char*>(p), (std::streamsize)n);
+	__THROW_RUNTIME_ERROR(!out, "serialize: write failed");
+}
+
+inline void __read_bytes(std::istream& in, void* p, size_t n) {
+	in.read(static_cast<char*>(p), (std::streamsize)n);
+	__THROW_RUNTIME_ERROR(!in, "deserialize: unexpected end of stream");
+}
+
+inline void __write_size(std::ostream& out, size_t n) {
+	const uint64_t len = n;
+	__write_bytes(out, &len, sizeof(len));
+}
+
+inline size_t __read_size(std::istream& in) {
+	uint64_t len;
+	__read_bytes(in, &len, sizeof(len));
+	return (size_t)len;
+}
+
+//从流中构造一个T；pair<const K, V>这类不能先构造再赋值的类型在下面特化
+template <typename T>
+struct __loader {
+	static T load(std::istream& in) {
+		T x;
+		serializer<T>::read(in, x);
+		return x;
+	}
+};
+
+template <typename T1, typename T2>
+struct __loader<pair<T1, T2>> {
+	static pair<T1, T2> load(std::istream& in) {
+		pair<typename std::remove_const<T1>::type, T2> x;
+		serializer<pair<typename std::remove_const<T1>::type, T2>>::read(in, x);
+		return pair<T1, T2>(lmstl::move(x.first), lmstl::move(x.second));
+	}
+};
+
+//连续存放的n个元素，可平凡复制时一次写出
+template <typename T>
+inline void __write_n(std::ostream& out, const T* p, size_t n) {
+	if constexpr (std::is_trivially_copyable<T>::value)
+		__write_bytes(out, p, n * sizeof(T));
+	else
+		for (size_t i = 0; i != n; ++i)
+			serializer<T>::write(out, p[i]);
+}
+
+//不连续的元素：可平凡复制时先攒进缓冲区再成块写出
+template <typename T, typename InputIterator>
+inline void __write_each(std::ostream& out, InputIterator beg, InputIterator end) {
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		char buf[sizeof(T) > __SERIALIZE_BUF_SIZE ? sizeof(T) : __SERIALIZE_BUF_SIZE];
+		size_t used = 0;
+		for (; beg != end; ++beg) {
+			if (used + sizeof(T) > sizeof(buf)) {
+				__write_bytes(out, buf, used);
+				used = 0;
+			}
+			memcpy(buf + used, &*beg, sizeof(T));
+			used += sizeof(T);
+		}
+		if (used)
+			__write_bytes(out, buf, used);
+	}
+	else
+		for (; beg != end; ++beg)
+			serializer<T>::write(out, *beg);
+}
+
+//依次读出n个T交给fn(T&)，可平凡复制时成块读入缓冲区
+template <typename T, typename Function>
+inline void __read_each(std::istream& in, size_t n, Function fn) {
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		alignas(T) char buf[sizeof(T) > __SERIALIZE_BUF_SIZE ? sizeof(T) : __SERIALIZE_BUF_SIZE];
+		const size_t per = sizeof(buf) / sizeof(T);
+		while (n) {
+			const size_t cnt = n < per ? n : per;
+			__read_bytes(in, buf, cnt * sizeof(T));
+			for (size_t i = 0; i != cnt; ++i)
+				fn(reinterpret_cast<T*>(buf)[i]);
+			n -= cnt;
+		}
+	}
+	else
+		for (; n; --n) {
+			T x = __loader<T>::load(in);
+			fn(x);
+		}
+}
+
+template <typename T>
+struct serializer<T, typename enable_if<std::is_trivially_copyable<T>::value>::type> {
+	static void write(std::ostream& out, const T& x) {
+		__write_bytes(out, &x, sizeof(T));
+	}
+	static void read(std::istream& in, T& x) {
+		__read_bytes(in, &x, sizeof(T));
+	}
+};
+
+//不可平凡复制的pair逐个成员读写；可平凡复制的pair走上面的整块读写
+template <typename T1, typename T2>
+struct serializer<pair<T1, T2>, typename enable_if<!std::is_trivially_copyable<pair<T1, T2>>::value>::type> {
+	static void write(std::ostream& out, const pair<T1, T2>& x) {
+		serializer<typename std::remove_const<T1>::type>::write(out, x.first);
+		serializer<T2>::write(out, x.second);
+	}
+	static void read(std::istream& in, pair<T1, T2>& x) {
+		serializer<T1>::read(in, x.first);
+		serializer<T2>::read(in, x.second);
+	}
+};
+
+template <typename CharT, typename Traits, typename Alloc>
+struct serializer<std::basic_string<CharT, Traits, Alloc>> {
+	static void write(std::ostream& out, const std::basic_string<CharT, Traits, Alloc>& x) {
+		__write_size(out, x.size());
+		__write_bytes(out, x.data(), x.size() * sizeof(CharT));
+	}
+	static void read(std::istream& in, std::basic_string<CharT, Traits, Alloc>& x) {
+		x.resize(__read_size(in));
+		if (!x.empty())
+			__read_bytes(in, &x[0], x.size() * sizeof(CharT));
+	}
+};
+
+//读入时先构造到临时容器中，出错抛出异常时x保持原样
+template <typename T, typename Alloc, typename Growth>
+struct serializer<vector<T, Alloc, Growth>> {
+	static void write(std::ostream& out, const vector<T, Alloc, Growth>& x) {
+		__write_size(out, x.size());
+		__write_n(out, x.data(), x.size());
+	}
+	static void read(std::istream& in, vector<T, Alloc, Growth>& x) {
+		const size_t n = __read_size(in);
+		vector<T, Alloc, Growth> tmp(x.get_allocator());
+		if constexpr (std::is_trivially_copyable<T>::value) {
+			for (size_t done = 0; done != n; ) {
+				const size_t cnt = min(n - done, __serialize_chunk<T>());
+				tmp.insert(tmp.end(), cnt, T());
+				__read_bytes(in, tmp.data() + done, cnt * sizeof(T));
+				done += cnt;
+			}
+		}
+		else {
+			tmp.reserve(min(n, __serialize_chunk<T>()));
+			__read_each<T>(in, n, [&](T& v) { tmp.push_back(lmstl::move(v)); });
+		}
+		x.swap(tmp);
+	}
+};
+
+//deque按缓冲区分段写出，每段是一块连续内存；读入时经缓冲区逐个push_back
+template <typename T, typename Alloc, size_t Buff_size>
+struct serializer<deque<T, Alloc, Buff_size>> {
+	static void write(std::ostream& out, const deque<T, Alloc, Buff_size>& x) {
+		size_t n = x.size();
+		__write_size(out, n);
+		for (typename deque<T, Alloc, Buff_size>::const_iterator it = x.begin(); n; ) {
+			const size_t seg = min(size_t(it.last - it.cur), n);
+			__write_n(out, (const T*)it.cur, seg);
+			n -= seg;
+			if (n)
+				it += seg;
+		}
+	}
+	static void read(std::istream& in, deque<T, Alloc, Buff_size>& x) {
+		deque<T, Alloc, Buff_size> tmp(x.get_allocator());
+		__read_each<T>(in, __read_size(in), [&](T& v) { tmp.push_back(lmstl::move(v)); });
+		x.swap(tmp);
+	}
+};
+
+template <typename T, typename Alloc>
+struct serializer<list<T, Alloc>> {
+	static void write(std::ostream& out, const list<T, Alloc>& x) {
+		__write_size(out, x.size());
+		__write_each<T>(out, x.begin(), x.end());
+	}
+	static void read(std::istream& in, list<T, Alloc>& x) {
+		list<T, Alloc> tmp(x.get_allocator());
+		__read_each<T>(in, __read_size(in), [&](T& v) { tmp.push_back(lmstl::move(v)); });
+		x.swap(tmp);
+	}
+};
+
+//先把n个元素全部读进buf，流中途出错时抛出异常，目标容器不受影响
+template <typename T>
+inline void __read_all(std::istream& in, size_t n, vector<T>& buf) {
+	buf.reserve(min(n, __serialize_chunk<T>()));
+	__read_each<T>(in, n, [&](T& v) { buf.push_back(lmstl::move(v)); });
+}
+
+//有序容器按中序写出，读入时元素已经有序，用assign_sorted在O(n)内直接建树
+template <typename Container>
+struct __sorted_serializer {
+	typedef typename Container::value_type value_type;
+
+	static void write(std::ostream& out, const Container& x) {
+		__write_size(out, x.size());
+		__write_each<value_type>(out, x.begin(), x.end());
+	}
+	static void read(std::istream& in, Container& x) {
+		vector<value_type> buf;
+		__read_all(in, __read_size(in), buf);
+		x.assign_sorted(buf.begin(), buf.end());
+	}
+};
+
+template <typename Key, typename Compare, typename Alloc>
+struct serializer<set<Key, Compare, Alloc>> : public __sorted_serializer<set<Key, Compare, Alloc>> {};
+
+template <typename Key, typename Compare, typename Alloc>
+struct serializer<multiset<Key, Compare, Alloc>> : public __sorted_serializer<multiset<Key, Compare, Alloc>> {};
+
+template <typename Key, typename T, typename Compare, typename Alloc>
+struct serializer<map<Key, T, Compare, Alloc>> : public __sorted_serializer<map<Key, T, Compare, Alloc>> {};
+
+template <typename Key, typename T, typename Compare, typename Alloc>
+struct serializer<multimap<Key, T, Compare, Alloc>> : public __sorted_serializer<multimap<Key, T, Compare, Alloc>> {};
+
+//哈希表不记录是否允许重复键，读入时一律insert_equal，原样还原所有元素
+template <typename Key, typename Value, typename HashFcn, typename ExtractKey, typename EqualKey, typename Alloc>
+struct serializer<hashtable<Key, Value, HashFcn, ExtractKey, EqualKey, Alloc>> {
+	typedef hashtable<Key, Value, HashFcn, ExtractKey, EqualKey, Alloc> table;
+
+	static void write(std::ostream& out, const table& x) {
+		__write_size(out, x.size());
+		__write_each<Value>(out, x.begin(), x.end());
+	}
+	static void read(std::istream& in, table& x) {
+		vector<Value> buf;
+		__read_all(in, __read_size(in), buf);
+		x.clear();
+		x.resize(buf.size());
+		for (size_t i = 0; i != buf.size(); ++i)
+			x.insert_equal(buf[i]);
+	}
+};
+
+template <typename Container>
+struct __unordered_serializer {
+	typedef typename Container::value_type value_type;
+
+	static void write(std::ostream& out, const Container& x) {
+		__write_size(out, x.size());
+		__write_each<value_type>(out, x.begin(), x.end());
+	}
+	static void read(std::istream& in, Container& x) {
+		vector<value_type> buf;
+		__read_all(in, __read_size(in), buf);
+		x.clear();
+		for (size_t i = 0; i != buf.size(); ++i)
+			x.insert(buf[i]);
+	}
+};
+
+template <typename Key, typename T, typename HashFcn, typename EqualKey, typename Alloc>
+struct serializer<unordered_map<Key, T, HashFcn, EqualKey, Alloc>> : public __unordered_serializer<unordered_map<Key, T, HashFcn, EqualKey, Alloc>> {};
+
+template <typename Value, typename HashFcn, typename EqualKey, typename Alloc>
+struct serializer<unordered_set<Value, HashFcn, EqualKey, Alloc>> : public __unordered_serializer<unordered_set<Value, HashFcn, EqualKey, Alloc>> {};
+
+}
+#endif // !__LMSTL_SERIALIZE_H__
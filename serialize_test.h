@@ -0,0 +1,282 @@
+#ifndef __LMSTL_SERIALIZE_TEST_H__
+#define __LMSTL_SERIALIZE_TEST_H__
+
+#include "test_frame.h"
+#include "serialize.h"
+#include "functional.h"
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <set>
+#include <map>
+#include <stdexcept>
+#include <stdlib.h>
+#include <time.h>
+
+namespace lmstl {
+
+//写出x再读回到y，y原有的内容应被替换
+template <typename Container>
+Container& serialize_round_trip(const Container& x, Container& y) {
+	std::stringstream io;
+	serialize(io, x);
+	deserialize(io, y);
+	return y;
+}
+
+template <typename T>
+bool serialize_equal(const T& x, const T& y) {
+	return x == y;
+}
+
+template <typename T1, typename T2>
+bool serialize_equal(const pair<T1, T2>& x, const pair<T1, T2>& y) {
+	return x.first == y.first && x.second == y.second;
+}
+
+template <typename Container1, typename Container2>
+bool serialize_same(const Container1& x, const Container2& y) {
+	if (x.size() != y.size())
+		return false;
+	auto j = y.begin();
+	for (auto i = x.begin(); i != x.end(); ++i, ++j)
+		if (!serialize_equal(*i, *j))
+			return false;
+	return true;
+}
+
+//把x写出后截掉最后cut个字节，从中读入y应抛出runtime_error且y保持原样
+template <typename Container>
+bool serialize_truncated(const Container& x, Container& y, size_t cut) {
+	std::stringstream io;
+	serialize(io, x);
+	std::string bytes = io.str();
+	bytes.resize(bytes.size() - cut);
+	std::stringstream bad(bytes);
+	Container before(y);
+	try {
+		deserialize(bad, y);
+	}
+	catch (std::runtime_error&) {
+		return serialize_same(y, before);
+	}
+	return false;
+}
+
+//流中的元素个数被破坏成极大的值时，应在读到流尾时抛出runtime_error，而不是先按个数分配内存
+template <typename Container>
+bool serialize_bad_count(Container& y) {
+	std::stringstream io;
+	__write_size(io, size_t(1) << 60);
+	__write_size(io, 0);
+	try {
+		deserialize(io, y);
+	}
+	catch (std::runtime_error&) {
+		return true;
+	}
+	return false;
+}
+
+//复制构造次数用完后抛出异常，用来检查assign_sorted中途失败
+struct __copy_budget {
+	int v;
+	static int budget;
+
+	__copy_budget(int x = 0): v(x) {}
+	__copy_budget(const __copy_budget& x): v(x.v) {
+		if (budget == 0)
+			throw std::runtime_error("copy budget exhausted");
+		if (budget > 0)
+			--budget;
+	}
+	__copy_budget& operator=(const __copy_budget&) = default;
+	bool operator<(const __copy_budget& x) const { return v < x.v; }
+	bool operator==(const __copy_budget& x) const { return v == x.v; }
+};
+
+int __copy_budget::budget = -1;
+
+inline bool assign_sorted_throw_keeps() {
+	set<__copy_budget> s;
+	for (int i = 0; i < 10; ++i)
+		s.insert(__copy_budget(i * 2));
+	std::vector<__copy_budget> src;
+	for (int i = 0; i < 100; ++i)
+		src.push_back(__copy_budget(i));
+	__copy_budget::budget = 37;
+	bool thrown = false;
+	try {
+		s.assign_sorted(src.data(), src.data() + src.size());
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	__copy_budget::budget = -1;
+	int expect = 0;
+	for (set<__copy_budget>::iterator it = s.begin(); it != s.end(); ++it, expect += 2)
+		if (it->v != expect)
+			return false;
+	return thrown && s.size() == 10;
+}
+
+struct __serialize_hash {
+	size_t operator()(int x) const { return (size_t)x * 2654435761u; }
+};
+
+//用len个有序的键值对建map，sorted为true时用assign_sorted，否则逐个insert，返回毫秒数
+inline int map_build_time(size_t len, bool sorted) {
+	std::vector<pair<int, int>> src;
+	for (size_t i = 0; i < len; ++i)
+		src.push_back(pair<int, int>((int)i, rand()));
+	map<int, int> m;
+	clock_t start = clock();
+	if (sorted)
+		m.assign_sorted(src.data(), src.data() + len);
+	else
+		for (size_t i = 0; i < len; ++i)
+			m.insert(src[i]);
+	clock_t end = clock();
+	return m.size() == len ? (int)(static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000) : -1;
+}
+
+#define MAP_BUILD_TIMING(sorted, len) do{	\
+	std::string t = std::to_string(map_build_time(len, sorted));	\
+	t += "ms    |";	\
+	cout << std::setw(WIDE) << t;	\
+}while(0)
+
+#define MAP_BUILD_PERF_TEST(name, sorted, len1, len2, len3) do{	\
+	cout << "|---------------------|-------------|-------------|-------------|\n";	\
+	std::string l1(#len1), l2(#len2), l3(#len3);	\
+	l1+="   |";l2+="   |";l3+="   |";	\
+	cout << "|" << std::setw(WIDE2) << "build map     |";	\
+	cout<<std::setw(WIDE)<<l1<<std::setw(WIDE)<<l2<<std::setw(WIDE)<<l3<<"\n|" << name;	\
+	MAP_BUILD_TIMING(sorted, len1);	\
+	MAP_BUILD_TIMING(sorted, len2);	\
+	MAP_BUILD_TIMING(sorted, len3);	\
+	cout << endl;	\
+}while(0)
+
+void serialize_test() {
+	API_TEST_START();
+	cout << "[----------------------- serialize test ------------------------]\n";
+	vector<int> mv;
+	std::vector<int> sv;
+	deque<std::string> md;
+	std::deque<std::string> sd;
+	list<std::string> ml;
+	std::list<std::string> sl;
+	map<int, std::string> mm;
+	std::map<int, std::string> sm;
+	multiset<int> mms;
+	std::multiset<int> sms;
+	for (int i = 0; i < 3000; ++i) {
+		mv.push_back(i * 3);
+		sv.push_back(i * 3);
+		md.push_back(std::to_string(i));
+		sd.push_back(std::to_string(i));
+		ml.push_front(std::to_string(i));
+		sl.push_front(std::to_string(i));
+		mm[i * 7 % 3001] = std::to_string(i);
+		sm[i * 7 % 3001] = std::to_string(i);
+		mms.insert(i % 17);
+		sms.insert(i % 17);
+	}
+	vector<int> mv2(5, 1);
+	serialize_round_trip(mv, mv2);
+	API_COMPARE(mv2, sv);
+	vector<std::string> mvs2;
+	vector<std::string> mvs(md.begin(), md.end());
+	serialize_round_trip(mvs, mvs2);
+	API_COMPARE(mvs2, sd);
+	deque<std::string> md2;
+	serialize_round_trip(md, md2);
+	API_COMPARE(md2, sd);
+	deque<int> mdi, mdi2;
+	for (int i = 0; i < 3000; ++i)
+		mdi.push_back(i * 3);
+	serialize_round_trip(mdi, mdi2);
+	API_COMPARE(mdi2, sv);
+	list<std::string> ml2;
+	serialize_round_trip(ml, ml2);
+	API_COMPARE(ml2, sl);
+	map<int, std::string> mm2;
+	mm2[-1] = "old";
+	serialize_round_trip(mm, mm2);
+	API_COMPARE(mm2, sm);
+	multiset<int> mms2;
+	serialize_round_trip(mms, mms2);
+	API_COMPARE(mms2, sms);
+	std::string str(100, 'x'), str2;
+	API_CHECK("string round trip", serialize_round_trip(str, str2) == str);
+
+	typedef hashtable<int, int, __serialize_hash, identity<int>, equal_to<int>> table;
+	table mh(10, __serialize_hash(), equal_to<int>());
+	table mh2(10, __serialize_hash(), equal_to<int>());
+	for (int i = 0; i < 1000; ++i)
+		mh.insert_equal(i % 300);
+	mh2.insert_equal(-5);
+	serialize_round_trip(mh, mh2);
+	API_CHECK("hashtable round trip", mh2.size() == 1000 && mh2.count(7) == mh.count(7) && !mh2.count(-5));
+
+	API_CHECK("truncated vector", serialize_truncated(mv, mv2, 4));
+	API_CHECK("truncated deque", serialize_truncated(md, md2, 1));
+	API_CHECK("truncated list", serialize_truncated(ml, ml2, 3));
+	API_CHECK("truncated map", serialize_truncated(mm, mm2, 2));
+	API_CHECK("truncated multiset", serialize_truncated(mms, mms2, 4));
+	table mh3(mh2);
+	std::stringstream hio;
+	serialize(hio, mh);
+	std::string hbytes = hio.str();
+	hbytes.resize(hbytes.size() - 4);
+	std::stringstream hbad(hbytes);
+	bool hthrown = false;
+	try {
+		deserialize(hbad, mh3);
+	}
+	catch (std::runtime_error&) {
+		hthrown = true;
+	}
+	API_CHECK("truncated hashtable", hthrown && mh3.size() == mh2.size());
+	API_CHECK("corrupt count vector", serialize_bad_count(mv2));
+	API_CHECK("corrupt count map", serialize_bad_count(mm2));
+	API_CHECK("corrupt count hashtable", serialize_bad_count(mh3));
+
+	cout << "[------------------------ assign_sorted ------------------------]\n";
+	std::vector<pair<int, int>> sorted_src;
+	std::map<int, int> sorted_std;
+	for (int i = 0; i < 1000; ++i) {
+		sorted_src.push_back(pair<int, int>(i * 2, i));
+		sorted_std[i * 2] = i;
+	}
+	map<int, int> sorted_map;
+	sorted_map[5] = 5;
+	sorted_map.assign_sorted(sorted_src.data(), sorted_src.data() + sorted_src.size());
+	API_COMPARE(sorted_map, sorted_std);
+	sorted_map[1] = -1;
+	sorted_std[1] = -1;
+	API_COMPARE(sorted_map, sorted_std);
+	std::swap(sorted_src[3], sorted_src[700]);
+	sorted_map.assign_sorted(sorted_src.data(), sorted_src.data() + sorted_src.size());
+	sorted_std.erase(1);
+	API_COMPARE(sorted_map, sorted_std);
+	int dup[] = { 1, 1, 2, 3, 3, 3, 9 };
+	multiset<int> sorted_ms;
+	sorted_ms.assign_sorted(dup, dup + 7);
+	std::multiset<int> sorted_sms(dup, dup + 7);
+	API_COMPARE(sorted_ms, sorted_sms);
+	API_CHECK("assign_sorted keeps the tree when a copy throws", assign_sorted_throw_keeps());
+	API_TEST_END();
+	PERF_TEST_START();
+	cout << "[------------------------ assign_sorted ------------------------]\n";
+	MAP_BUILD_PERF_TEST("      insert         |", false, 100000, 1000000, 3000000);
+	MAP_BUILD_PERF_TEST("   assign_sorted     |", true, 100000, 1000000, 3000000);
+	PERF_TEST_END();
+}
+
+}
+
+#endif // !__LMSTL_SERIALIZE_TEST_H__
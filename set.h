@@ -14,6 +14,7 @@ public:
 	typedef Key value_type;
 	typedef Compare key_compare;
 	typedef Compare value_compare;
+	typedef Alloc allocator_type;
 
 private:
 	typedef rb_tree<key_type, value_type, identity<value_type>, key_compare, Alloc> rep_type;
@@ -32,6 +33,12 @@ public:
 	set():
 		t(Compare()) {}
 
+	explicit set(const Alloc& a):
+		t(Compare(), a) {}
+
+	set(const Compare& comp, const Alloc& a):
+		t(comp, a) {}
+
 	template <typename InputIterator>
 	set(InputIterator beg, InputIterator end):
 		t(Compare()) {
@@ -53,6 +60,8 @@ public:
 	}
 
 	key_compare key_comp() const { return t.key_comp(); }
+	allocator_type get_allocator() const { return t.get_allocator(); }
+	void swap(set& x) { t.swap(x.t); }
 	value_compare value_comp() const { return t.key_comp(); }
 	iterator begin() const { return t.begin(); }
 	iterator end() const { return t.end(); }
@@ -68,6 +77,11 @@ public:
 		t.insert_unique(beg, end);
 	}
 
+	template <typename ForwardIterator>
+	void assign_sorted(ForwardIterator beg, ForwardIterator end) {
+		t.assign_sorted_unique(beg, end);
+	}
+
 	void erase(iterator position) {
 		t.erase(position);
 	}
@@ -109,6 +123,7 @@ public:
 	typedef Key value_type;
 	typedef Compare key_compare;
 	typedef Compare value_compare;
+	typedef Alloc allocator_type;
 
 private:
 	typedef rb_tree<key_type, value_type, identity<value_type>, key_compare, Alloc> rep_type;
@@ -127,6 +142,12 @@ public:
 	multiset() :
 		t(Compare()) {}
 
+	explicit multiset(const Alloc& a):
+		t(Compare(), a) {}
+
+	multiset(const Compare& comp, const Alloc& a):
+		t(comp, a) {}
+
 	template <typename InputIterator>
 	multiset(InputIterator beg, InputIterator end) :
 		t(Compare()) {
@@ -148,13 +169,15 @@ public:
 	}
 
 	key_compare key_comp() const { return t.key_comp(); }
+	allocator_type get_allocator() const { return t.get_allocator(); }
+	void swap(multiset& x) { t.swap(x.t); }
 	value_compare value_comp() const { return t.key_comp(); }
 	iterator begin() const { return t.begin(); }
 	iterator end() const { return t.end(); }
 	bool empty() const { return t.empty(); }
 	size_type size() const { return t.size(); }
 
-	pair<iterator, bool> insert(const value_type& x) {
+	iterator insert(const value_type& x) {
 		return t.insert_equal(x);
 	}
 
@@ -163,6 +186,11 @@ public:
 		t.insert_equal(beg, end);
 	}
 
+	template <typename ForwardIterator>
+	void assign_sorted(ForwardIterator beg, ForwardIterator end) {
+		t.assign_sorted_equal(beg, end);
+	}
+
 	void erase(iterator position) {
 		t.erase(position);
 	}
@@ -0,0 +1,345 @@
+#ifndef __LMSTL_SMALL_VECTOR_H__
+#define __LMSTL_SMALL_VECTOR_H__
+
+#include "alloc.h"
+#include "iterator.h"
+#include "uninitialized.h"
+#include "exceptdef.h"
+#include "type_traits.h"
+#include "algobase.h"
+#include <stddef.h>
+
+namespace lmstl {
+
+//前N个元素放在对象内部的缓冲区里，超过N个才向分配器申请空间，接口与vector相同
+//溢出到堆上之后不再搬回内部缓冲区，直到对象析构
+template <typename T, size_t N, typename Alloc = alloc>
+class small_vector : private alloc_holder<Alloc> {
+	static_assert(N > 0, "small_vector needs at least one inline element");
+
+public:
+	typedef T					value_type;
+	typedef value_type*			pointer;
+	typedef const value_type*	const_pointer;
+	typedef value_type&			reference;
+	typedef const value_type&	const_reference;
+	typedef ptrdiff_t			difference_type;
+	typedef size_t				size_type;
+
+	typedef value_type*			iterator;
+	typedef const value_type*	const_iterator;
+	typedef reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef reverse_iterator<iterator> reverse_iterator;
+	typedef Alloc				allocator_type;
+
+	static const size_type inline_capacity = N;
+
+public:
+	small_vector():
+		start(inline_begin()), finish(start), end_of_storage(start + N) {}
+	explicit small_vector(const Alloc& a):
+		alloc_base(a), start(inline_begin()), finish(start), end_of_storage(start + N) {}
+	small_vector(size_type n, const T& val, const Alloc& a = Alloc()):
+		small_vector(a) {
+		reserve(n);
+		finish = lmstl::uninitialized_fill_n(start, n, val);
+	}
+	explicit small_vector(size_type n, const Alloc& a = Alloc()):
+		small_vector(a) {
+		reserve(n);
+		finish = lmstl::uninitialized_fill_n(start, n, T());
+	}
+	small_vector(const small_vector& x):
+		small_vector(x.get_alloc()) {
+		reserve(x.size());
+		finish = lmstl::uninitialized_copy(x.begin(), x.end(), start);
+	}
+	small_vector(small_vector&& x) noexcept :
+		small_vector(x.get_alloc()) {
+		steal(x);
+	}
+
+	template <typename InputIter, typename = typename enable_if<
+		is_input_iterator_v<InputIter>>::type>
+	small_vector(InputIter beg, InputIter end, const Alloc& a = Alloc()):
+		small_vector(a) {
+		reserve((size_type)lmstl::distance(beg, end));
+		finish = lmstl::uninitialized_copy(beg, end, start);
+	}
+
+	~small_vector() {
+		destroy(start, finish);
+		if (!is_inline())
+			data_allocator::deallocate(this->get_alloc(), start, capacity());
+	}
+
+	small_vector& operator=(const small_vector& x) {
+		if (this != &x) {
+			clear();
+			reserve(x.size());
+			finish = lmstl::uninitialized_copy(x.begin(), x.end(), start);
+		}
+		return *this;
+	}
+	small_vector& operator=(small_vector&& x) noexcept {
+		if (this != &x) {
+			clear();
+			if (!is_inline()) {
+				data_allocator::deallocate(this->get_alloc(), start, capacity());
+				reset_inline();
+			}
+			this->swap_alloc(x);
+			steal(x);
+		}
+		return *this;
+	}
+
+	allocator_type get_allocator() const { return this->get_alloc(); }
+
+protected:
+	typedef alloc_holder<Alloc> alloc_base;
+	typedef simple_alloc<value_type, Alloc> data_allocator;
+	iterator start;
+	iterator finish;
+	iterator end_of_storage;
+	alignas(T) unsigned char buf[sizeof(T) * N];
+
+private:
+	iterator inline_begin() noexcept { return reinterpret_cast<iterator>(buf); }
+	void reset_inline() noexcept {
+		start = finish = inline_begin();
+		end_of_storage = start + N;
+	}
+
+	//x在堆上时直接接管指针，否则把元素逐个搬进自己的内部缓冲区；本对象必须为空且使用内部缓冲区
+	void steal(small_vector& x) noexcept {
+		if (x.is_inline()) {
+			finish = lmstl::uninitialized_relocate(x.start, x.finish, start);
+			x.finish = x.start;
+		}
+		else {
+			start = x.start;
+			finish = x.finish;
+			end_of_storage = x.end_of_storage;
+			x.reset_inline();
+		}
+	}
+
+	//换到容量为new_size的堆空间，元素整体重定位过去
+	void grow(size_type new_size) {
+		iterator new_start = data_allocator::allocate(this->get_alloc(), new_size);
+		iterator new_finish = lmstl::uninitialized_relocate(start, finish, new_start);
+		if (!is_inline())
+			data_allocator::deallocate(this->get_alloc(), start, capacity());
+		start = new_start;
+		finish = new_finish;
+		end_of_storage = start + new_size;
+	}
+
+	//保证还能再放n个元素，返回pos在新空间中对应的位置
+	iterator make_room(iterator pos, size_type n) {
+		if (size_type(end_of_storage - finish) >= n)
+			return pos;
+		const size_type index = pos - start;
+		grow(capacity() + max(capacity(), n));
+		return start + index;
+	}
+
+public:
+
+	iterator begin() noexcept { return start; }
+	const_iterator begin() const noexcept { return start; }
+	const_iterator cbegin() const noexcept { return start; }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(finish); }
+	const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(finish); }
+
+	iterator end() { return finish; }
+	const_iterator end() const noexcept { return finish; }
+	const_iterator cend() const noexcept { return finish; }
+	reverse_iterator rend() noexcept { return reverse_iterator(start); }
+	const_reverse_iterator rend() const noexcept { return const_reverse_iterator(start); }
+
+	size_type size() const noexcept { return size_type(finish - start); }
+	size_type capacity() const noexcept { return size_type(end_of_storage - start); }
+	bool empty() const noexcept { return (start == finish); }
+	bool is_inline() const noexcept { return start == reinterpret_cast<const_pointer>(buf); }
+
+	pointer data() noexcept { return start; }
+	const_pointer data() const noexcept { return start; }
+
+	void swap(small_vector& x) {
+		if (this == &x)
+			return;
+		if (!is_inline() && !x.is_inline()) {
+			lmstl::swap(start, x.start);
+			lmstl::swap(finish, x.finish);
+			lmstl::swap(end_of_storage, x.end_of_storage);
+			this->swap_alloc(x);
+			return;
+		}
+		small_vector tmp(lmstl::move(x));
+		x = lmstl::move(*this);
+		*this = lmstl::move(tmp);
+	}
+
+	reference operator[](size_type n) {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return *(start + n);
+	}
+	const_reference operator[](size_type n) const {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return *(start + n);
+	}
+
+	reference at(size_type n) {
+		__THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return *(start + n);
+	}
+	const_reference at(size_type n) const {
+		__THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return *(start + n);
+	}
+
+	reference unchecked_at(size_type n) noexcept { return *(start + n); }
+	const_reference unchecked_at(size_type n) const noexcept { return *(start + n); }
+
+	reference front() noexcept { return *start; }
+	const_reference front() const noexcept { return *start; }
+	reference back() noexcept { return *(finish - 1); }
+	const_reference back() const noexcept { return *(finish - 1); }
+
+	void push_back(const T& val) {
+		if (finish != end_of_storage) {
+			construct(&*finish, val);
+			++finish;
+		}
+		else
+			emplace(finish, val);
+	}
+
+	void push_back(T&& val) {
+		if (finish != end_of_storage) {
+			construct(&*finish, lmstl::move(val));
+			++finish;
+		}
+		else
+			emplace(finish, lmstl::move(val));
+	}
+
+	template <typename... Args>
+	void emplace_back(Args&&... args) {
+		if (finish != end_of_storage) {
+			construct(&*finish, lmstl::forward<Args>(args)...);
+			++finish;
+		}
+		else
+			emplace(finish, lmstl::forward<Args>(args)...);
+	}
+
+	void pop_back() {
+		__THROW_RUNTIME_ERROR(empty(), "pop_back on empty small_vector");
+		--finish;
+		destroy(finish);
+	}
+
+	iterator erase(iterator xbeg, iterator xend) {
+		__THROW_OUT_OF_RANGE_ERROR(!(xbeg <= xend && xbeg >= start && xend <= finish), "Range Error");
+		iterator p = lmstl::move(xend, finish, xbeg);
+		destroy(p, finish);
+		finish = p;
+		return xbeg;
+	}
+	iterator erase(iterator pos) {
+		__THROW_OUT_OF_RANGE_ERROR((pos >= finish || pos < start), "Range Error");
+		if (pos + 1 != finish)
+			lmstl::move(pos + 1, finish, pos);
+		--finish;
+		destroy(finish);
+		return pos;
+	}
+
+	void reserve(size_type n) {
+		if (n > capacity())
+			grow(n);
+	}
+
+	void clear() {
+		destroy(start, finish);
+		finish = start;
+	}
+
+	template <typename... Args>
+	iterator emplace(iterator pos, Args&&... args);
+	iterator insert(iterator pos, const value_type& val) {
+		return emplace(pos, val);
+	}
+	iterator insert(iterator pos, value_type&& val) {
+		return emplace(pos, lmstl::move(val));
+	}
+	iterator insert(iterator pos, size_type n, const T& val);
+
+	template <typename InputIterator, typename = typename enable_if<is_input_iterator_v<InputIterator>>::type>
+	void insert(iterator pos, InputIterator beg, InputIterator end);
+};
+
+template <typename T, size_t N, typename Alloc>
+template <typename... Args>
+typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::emplace(iterator pos, Args&&... args) {
+	T val(lmstl::forward<Args>(args)...);
+	pos = make_room(pos, 1);
+	if (pos == finish) {
+		construct(finish, lmstl::move(val));
+		++finish;
+		return pos;
+	}
+	construct(finish, lmstl::move(*(finish - 1)));
+	++finish;
+	lmstl::move_backward(pos, finish - 2, finish - 1);
+	*pos = lmstl::move(val);
+	return pos;
+}
+
+template <typename T, size_t N, typename Alloc>
+typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::insert(iterator pos, size_type n, const T& val) {
+	if (!n) return pos;
+	T val_copy = val;
+	pos = make_room(pos, n);
+	const size_type after_nums = finish - pos;
+	if (after_nums > n) {
+		lmstl::uninitialized_move(finish - n, finish, finish);
+		lmstl::move_backward(pos, finish - n, finish);
+		lmstl::fill_n(pos, n, val_copy);
+	}
+	else {
+		lmstl::uninitialized_move(pos, finish, pos + n);
+		lmstl::fill_n(pos, after_nums, val_copy);
+		lmstl::uninitialized_fill_n(finish, n - after_nums, val_copy);
+	}
+	finish += n;
+	return pos;
+}
+
+template <typename T, size_t N, typename Alloc>
+template <typename InputIterator, typename>
+void small_vector<T, N, Alloc>::insert(iterator pos, InputIterator beg, InputIterator end) {
+	const size_type len = (size_type)lmstl::distance(beg, end);
+	if (!len) return;
+	pos = make_room(pos, len);
+	const size_type after_nums = finish - pos;
+	if (after_nums > len) {
+		lmstl::uninitialized_move(finish - len, finish, finish);
+		lmstl::move_backward(pos, finish - len, finish);
+		lmstl::copy(beg, end, pos);
+	}
+	else {
+		InputIterator p = beg;
+		lmstl::advance(p, after_nums);
+		lmstl::uninitialized_move_n(pos, after_nums, pos + len);
+		lmstl::copy(beg, p, pos);
+		lmstl::uninitialized_copy(p, end, finish);
+	}
+	finish += len;
+}
+
+}
+#endif // !__LMSTL_SMALL_VECTOR_H__
@@ -0,0 +1,419 @@
+#ifndef __LMSTL_SOA_VECTOR_H__
+#define __LMSTL_SOA_VECTOR_H__
+
+#include "alloc.h"
+#include "iterator.h"
+#include "uninitialized.h"
+#include "exceptdef.h"
+#include "type_traits.h"
+#include "algobase.h"
+#include "vector.h"
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <stddef.h>
+
+namespace lmstl {
+
+//一段连续元素的视图，不拥有内存
+template <typename T>
+class span {
+public:
+	typedef T			value_type;
+	typedef T*			pointer;
+	typedef T&			reference;
+	typedef T*			iterator;
+	typedef ptrdiff_t	difference_type;
+	typedef size_t		size_type;
+
+	constexpr span() noexcept :
+		ptr(0), len(0) {}
+	constexpr span(T* p, size_type n) noexcept :
+		ptr(p), len(n) {}
+
+	constexpr iterator begin() const noexcept { return ptr; }
+	constexpr iterator end() const noexcept { return ptr + len; }
+	constexpr pointer data() const noexcept { return ptr; }
+	constexpr size_type size() const noexcept { return len; }
+	constexpr bool empty() const noexcept { return len == 0; }
+
+	constexpr reference operator[](size_type n) const {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= len, "Index out of range");
+		return ptr[n];
+	}
+	constexpr reference front() const noexcept { return ptr[0]; }
+	constexpr reference back() const noexcept { return ptr[len - 1]; }
+
+private:
+	T* ptr;
+	size_type len;
+};
+
+//soa_vector的迭代器只记下标，解引用得到由各列元素引用组成的tuple
+template <typename Vec, typename Ref>
+struct soa_iterator {
+	typedef random_access_iterator_tag	iterator_category;
+	typedef typename Vec::value_type	value_type;
+	typedef Ref							reference;
+	typedef void						pointer;
+	typedef ptrdiff_t					difference_type;
+	typedef soa_iterator<Vec, Ref>		self;
+
+	Vec* vec;
+	size_t idx;
+
+	soa_iterator():
+		vec(0), idx(0) {}
+	soa_iterator(Vec* v, size_t n):
+		vec(v), idx(n) {}
+	template <typename V, typename R>
+	soa_iterator(const soa_iterator<V, R>& x):
+		vec(x.vec), idx(x.idx) {}
+
+	reference operator*() const { return (*vec)[idx]; }
+	reference operator[](difference_type n) const { return (*vec)[idx + n]; }
+
+	self& operator++() { ++idx; return *this; }
+	self operator++(int) { self tmp = *this; ++idx; return tmp; }
+	self& operator--() { --idx; return *this; }
+	self operator--(int) { self tmp = *this; --idx; return tmp; }
+	self& operator+=(difference_type n) { idx += n; return *this; }
+	self& operator-=(difference_type n) { idx -= n; return *this; }
+	self operator+(difference_type n) const { return self(vec, idx + n); }
+	self operator-(difference_type n) const { return self(vec, idx - n); }
+	difference_type operator-(const self& x) const { return difference_type(idx) - difference_type(x.idx); }
+
+	bool operator==(const self& x) const { return idx == x.idx; }
+	bool operator!=(const self& x) const { return idx != x.idx; }
+	bool operator<(const self& x) const { return idx < x.idx; }
+	bool operator>(const self& x) const { return idx > x.idx; }
+	bool operator<=(const self& x) const { return idx <= x.idx; }
+	bool operator>=(const self& x) const { return idx >= x.idx; }
+};
+
+//按列存放的vector：每个字段一块连续数组，所有列共用同一个size和capacity
+//逐行访问得到的是引用tuple，按列处理时用column<I>()拿到连续的span，只读需要的字段
+//扩容策略与vector相同，可平凡重定位的列整块搬运
+template <typename Alloc, typename Growth, typename... Fields>
+class basic_soa_vector : private alloc_holder<Alloc> {
+	static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+
+public:
+	typedef std::tuple<Fields...>			value_type;
+	typedef std::tuple<Fields&...>			reference;
+	typedef std::tuple<const Fields&...>	const_reference;
+	typedef ptrdiff_t						difference_type;
+	typedef size_t							size_type;
+
+	typedef soa_iterator<basic_soa_vector, reference>				iterator;
+	typedef soa_iterator<const basic_soa_vector, const_reference>	const_iterator;
+	typedef reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef reverse_iterator<iterator> reverse_iterator;
+	typedef Alloc							allocator_type;
+	typedef Growth							growth_policy;
+
+	template <size_t I>
+	using field_type = typename std::tuple_element<I, value_type>::type;
+
+	static const size_type field_count = sizeof...(Fields);
+
+private:
+	typedef alloc_holder<Alloc> alloc_base;
+	typedef std::index_sequence_for<Fields...> indices;
+
+	std::tuple<Fields*...> cols;
+	size_type count;
+	size_type cap;
+
+public:
+	basic_soa_vector():
+		cols(), count(0), cap(0) {}
+	explicit basic_soa_vector(const Alloc& a):
+		alloc_base(a), cols(), count(0), cap(0) {}
+	explicit basic_soa_vector(size_type n, const Alloc& a = Alloc()):
+		basic_soa_vector(a) {
+		resize(n);
+	}
+	basic_soa_vector(const basic_soa_vector& x):
+		basic_soa_vector(x.get_alloc()) {
+		reserve(x.count);
+		for (; count != x.count; ++count)
+			put_row(count, x[count], indices());
+	}
+	basic_soa_vector(basic_soa_vector&& x) noexcept :
+		alloc_base(lmstl::move(x.get_alloc())), cols(x.cols), count(x.count), cap(x.cap) {
+		x.cols = std::tuple<Fields*...>();
+		x.count = x.cap = 0;
+	}
+
+	~basic_soa_vector() {
+		clear();
+		release(indices());
+	}
+
+	basic_soa_vector& operator=(const basic_soa_vector& x) {
+		if (this != &x) {
+			basic_soa_vector tmp(x);
+			swap(tmp);
+		}
+		return *this;
+	}
+	basic_soa_vector& operator=(basic_soa_vector&& x) noexcept {
+		if (this != &x) {
+			clear();
+			release(indices());
+			this->swap_alloc(x);
+			cols = x.cols;
+			count = x.count;
+			cap = x.cap;
+			x.cols = std::tuple<Fields*...>();
+			x.count = x.cap = 0;
+		}
+		return *this;
+	}
+
+	allocator_type get_allocator() const { return this->get_alloc(); }
+
+public:
+
+	iterator begin() noexcept { return iterator(this, 0); }
+	const_iterator begin() const noexcept { return const_iterator(this, 0); }
+	const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+	iterator end() noexcept { return iterator(this, count); }
+	const_iterator end() const noexcept { return const_iterator(this, count); }
+	const_iterator cend() const noexcept { return const_iterator(this, count); }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+	size_type size() const noexcept { return count; }
+	size_type capacity() const noexcept { return cap; }
+	bool empty() const noexcept { return count == 0; }
+
+	template <size_t I>
+	field_type<I>* data() noexcept { return std::get<I>(cols); }
+	template <size_t I>
+	const field_type<I>* data() const noexcept { return std::get<I>(cols); }
+
+	template <size_t I>
+	span<field_type<I>> column() noexcept { return span<field_type<I>>(std::get<I>(cols), count); }
+	template <size_t I>
+	span<const field_type<I>> column() const noexcept { return span<const field_type<I>>(std::get<I>(cols), count); }
+
+	void swap(basic_soa_vector& x) {
+		lmstl::swap(cols, x.cols);
+		lmstl::swap(count, x.count);
+		lmstl::swap(cap, x.cap);
+		this->swap_alloc(x);
+	}
+
+	reference operator[](size_type n) {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= count, "Index out of range");
+		return row(n, indices());
+	}
+	const_reference operator[](size_type n) const {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= count, "Index out of range");
+		return row(n, indices());
+	}
+
+	reference at(size_type n) {
+		__THROW_OUT_OF_RANGE_ERROR(n >= count, "Index out of range");
+		return row(n, indices());
+	}
+	const_reference at(size_type n) const {
+		__THROW_OUT_OF_RANGE_ERROR(n >= count, "Index out of range");
+		return row(n, indices());
+	}
+
+	reference front() noexcept { return row(0, indices()); }
+	const_reference front() const noexcept { return row(0, indices()); }
+	reference back() noexcept { return row(count - 1, indices()); }
+	const_reference back() const noexcept { return row(count - 1, indices()); }
+
+	void push_back(const Fields&... vals) { append(vals...); }
+	void push_back(const value_type& val) { append_row(val, indices()); }
+	void push_back(value_type&& val) { append_row(lmstl::move(val), indices()); }
+
+	//每个字段一个参数，分别用来构造对应列的新元素
+	template <typename... Args>
+	void emplace_back(Args&&... args) {
+		static_assert(sizeof...(Args) == sizeof...(Fields), "emplace_back takes one argument per field");
+		append(lmstl::forward<Args>(args)...);
+	}
+
+	void pop_back() {
+		__THROW_RUNTIME_ERROR(empty(), "pop_back on empty soa_vector");
+		--count;
+		kill(count, count + 1, indices());
+	}
+
+	iterator erase(iterator xbeg, iterator xend) {
+		__THROW_OUT_OF_RANGE_ERROR(!(xbeg <= xend && xbeg >= begin() && xend <= end()), "Range Error");
+		if (xbeg != xend) {
+			shift_down(xbeg.idx, xend.idx, indices());
+			const size_type new_count = count - (xend.idx - xbeg.idx);
+			kill(new_count, count, indices());
+			count = new_count;
+		}
+		return xbeg;
+	}
+	iterator erase(iterator pos) {
+		__THROW_OUT_OF_RANGE_ERROR((pos >= end() || pos < begin()), "Range Error");
+		return erase(pos, pos + 1);
+	}
+
+	void resize(size_type n) {
+		if (n < count) {
+			kill(n, count, indices());
+			count = n;
+			return;
+		}
+		reserve(n);
+		for (; count != n; ++count)
+			put(count, indices(), Fields()...);
+	}
+
+	void reserve(size_type n) {
+		if (n > cap)
+			reallocate_storage(n, indices());
+	}
+
+	void shrink_to_fit() {
+		if (count == cap)
+			return;
+		if (!count) {
+			release(indices());
+			cols = std::tuple<Fields*...>();
+			cap = 0;
+			return;
+		}
+		reallocate_storage(count, indices());
+	}
+
+	void clear() {
+		kill(0, count, indices());
+		count = 0;
+	}
+
+private:
+	size_type next_capacity(size_type n) const {
+		return Growth::next(cap, count + n, row_bytes());
+	}
+
+	static constexpr size_t row_bytes() { return (sizeof(Fields) + ...); }
+
+	template <size_t... I>
+	reference row(size_type n, std::index_sequence<I...>) { return reference(std::get<I>(cols)[n]...); }
+	template <size_t... I>
+	const_reference row(size_type n, std::index_sequence<I...>) const { return const_reference(std::get<I>(cols)[n]...); }
+
+	//在列组c中逐列构造第n行，某一列抛出异常时析构已经构造好的列
+	template <size_t... I, typename... Args>
+	static void put_at(const std::tuple<Fields*...>& c, size_type n, std::index_sequence<I...>, Args&&... args) {
+		size_t done = 0;
+		try {
+			((lmstl::construct(std::get<I>(c) + n, lmstl::forward<Args>(args)), ++done), ...);
+		}
+		catch (...) {
+			((I < done ? lmstl::destroy(std::get<I>(c) + n) : void()), ...);
+			throw;
+		}
+	}
+	template <typename... Args>
+	void put(size_type n, indices seq, Args&&... args) {
+		put_at(cols, n, seq, lmstl::forward<Args>(args)...);
+	}
+	template <typename Tuple, size_t... I>
+	void put_row(size_type n, Tuple&& t, std::index_sequence<I...> seq) {
+		put(n, seq, std::get<I>(lmstl::forward<Tuple>(t))...);
+	}
+
+	//参数可能引用本容器的元素，扩容时先在新列中构造新行，再搬运旧元素、释放旧列
+	template <typename... Args>
+	void append(Args&&... args) {
+		if (count != cap) {
+			put(count, indices(), lmstl::forward<Args>(args)...);
+			++count;
+			return;
+		}
+		const size_type n = next_capacity(1);
+		std::tuple<Fields*...> fresh = allocate_columns(n, indices());
+		try {
+			put_at(fresh, count, indices(), lmstl::forward<Args>(args)...);
+		}
+		catch (...) {
+			deallocate_columns(fresh, n, field_count, indices());
+			throw;
+		}
+		adopt_storage(fresh, n, indices());
+		++count;
+	}
+	template <typename Tuple, size_t... I>
+	void append_row(Tuple&& t, std::index_sequence<I...>) {
+		append(std::get<I>(lmstl::forward<Tuple>(t))...);
+	}
+
+	template <size_t... I>
+	void kill(size_type first, size_type last, std::index_sequence<I...>) {
+		(lmstl::destroy(std::get<I>(cols) + first, std::get<I>(cols) + last), ...);
+	}
+
+	template <size_t... I>
+	void shift_down(size_type first, size_type last, std::index_sequence<I...>) {
+		(lmstl::move(std::get<I>(cols) + last, std::get<I>(cols) + count, std::get<I>(cols) + first), ...);
+	}
+
+	template <size_t... I>
+	void release(std::index_sequence<I...>) {
+		if (cap)
+			(simple_alloc<Fields, Alloc>::deallocate(this->get_alloc(), std::get<I>(cols), cap), ...);
+	}
+
+	//释放c中前done列，每列容量为n
+	template <size_t... I>
+	void deallocate_columns(const std::tuple<Fields*...>& c, size_type n, size_t done, std::index_sequence<I...>) {
+		((I < done ? simple_alloc<Fields, Alloc>::deallocate(this->get_alloc(), std::get<I>(c), n) : void()), ...);
+	}
+
+	//把所有新列都分配好才返回，分配中途失败时已分配的列被释放，原有数据不受影响
+	template <size_t... I>
+	std::tuple<Fields*...> allocate_columns(size_type n, std::index_sequence<I...> seq) {
+		std::tuple<Fields*...> fresh;
+		size_t done = 0;
+		try {
+			((std::get<I>(fresh) = simple_alloc<Fields, Alloc>::allocate(this->get_alloc(), n), ++done), ...);
+		}
+		catch (...) {
+			deallocate_columns(fresh, n, done, seq);
+			throw;
+		}
+		return fresh;
+	}
+
+	//把已有的count行搬到容量为n的新列fresh中，释放旧列
+	template <size_t... I>
+	void adopt_storage(const std::tuple<Fields*...>& fresh, size_type n, std::index_sequence<I...>) {
+		(lmstl::uninitialized_relocate(std::get<I>(cols), std::get<I>(cols) + count, std::get<I>(fresh)), ...);
+		release(indices());
+		cols = fresh;
+		cap = n;
+	}
+
+	template <size_t... I>
+	void reallocate_storage(size_type n, std::index_sequence<I...> seq) {
+		adopt_storage(allocate_columns(n, seq), n, seq);
+	}
+};
+
+template <typename... Fields>
+using soa_vector = basic_soa_vector<alloc, default_growth, Fields...>;
+
+template <typename Alloc, typename Growth, typename... Fields>
+inline void swap(basic_soa_vector<Alloc, Growth, Fields...>& x, basic_soa_vector<Alloc, Growth, Fields...>& y) {
+	x.swap(y);
+}
+
+}
+#endif // !__LMSTL_SOA_VECTOR_H__
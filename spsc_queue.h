@@ -0,0 +1,199 @@
+#ifndef __LMSTL_SPSC_QUEUE_H__
+#define __LMSTL_SPSC_QUEUE_H__
+
+#include "alloc.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "type_traits.h"
+#include "utility.h"
+#include <atomic>
+#include <new>
+#include <thread>
+#include <stdexcept>
+#include <stddef.h>
+
+namespace lmstl {
+
+//生产者和消费者各自改写的变量放在不同的缓存行，避免伪共享
+#ifndef __LMSTL_CACHE_LINE_SIZE
+#define __LMSTL_CACHE_LINE_SIZE 64
+#endif
+
+//有界无锁的单生产者单消费者队列，容量向上取整为2的幂
+//push系列只能在一个线程中调用，pop系列只能在另一个线程中调用
+//tail只由生产者写，head只由消费者写；双方各自缓存对方的位置，只有缓存的值显示满/空时才去读对方的缓存行
+//push_n/pop_n一次搬运多个元素，只发布一次位置，摊薄原子操作和缓存行传递的开销
+template <typename T, typename Alloc = alloc>
+class spsc_queue : private alloc_holder<Alloc> {
+public:
+	typedef T			value_type;
+	typedef T&			reference;
+	typedef const T&	const_reference;
+	typedef size_t		size_type;
+	typedef Alloc		allocator_type;
+
+private:
+	typedef simple_alloc<value_type, Alloc> data_allocator;
+	typedef alloc_holder<Alloc> alloc_base;
+
+	T* buf;
+	size_type mask;
+
+	//消费者
+	alignas(__LMSTL_CACHE_LINE_SIZE) std::atomic<size_type> head;
+	size_type tail_cache;
+
+	//生产者
+	alignas(__LMSTL_CACHE_LINE_SIZE) std::atomic<size_type> tail;
+	size_type head_cache;
+
+public:
+	explicit spsc_queue(size_type n, const Alloc& a = Alloc()):
+		alloc_base(a), buf(0), mask(0), head(0), tail_cache(0), tail(0), head_cache(0) {
+		__THROW_OUT_OF_RANGE_ERROR(n == 0, "spsc_queue needs a non-zero capacity");
+		size_type cap = 1;
+		while (cap < n)
+			cap <<= 1;
+		buf = data_allocator::allocate(this->get_alloc(), cap);
+		mask = cap - 1;
+	}
+	spsc_queue(const spsc_queue&) = delete;
+	spsc_queue& operator=(const spsc_queue&) = delete;
+
+	~spsc_queue() {
+		const size_type t = tail.load(std::memory_order_relaxed);
+		for (size_type h = head.load(std::memory_order_relaxed); h != t; ++h)
+			destroy(buf + (h & mask));
+		data_allocator::deallocate(this->get_alloc(), buf, mask + 1);
+	}
+
+	allocator_type get_allocator() const { return this->get_alloc(); }
+
+	size_type capacity() const noexcept { return mask + 1; }
+	//另一端同时在操作时只是一个近似值
+	size_type size() const noexcept {
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+	bool empty() const noexcept { return size() == 0; }
+
+	//生产者调用
+	bool try_push(const value_type& val) { return try_emplace(val); }
+	bool try_push(value_type&& val) { return try_emplace(lmstl::move(val)); }
+
+	template <typename... Args>
+	bool try_emplace(Args&&... args) {
+		const size_type t = tail.load(std::memory_order_relaxed);
+		if (t - head_cache > mask) {
+			head_cache = head.load(std::memory_order_acquire);
+			if (t - head_cache > mask)
+				return false;
+		}
+		new((void*)(buf + (t & mask))) T(lmstl::forward<Args>(args)...);
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	//队列满时自旋等待
+	void push(const value_type& val) {
+		while (!try_push(val))
+			std::this_thread::yield();
+	}
+	void push(value_type&& val) {
+		while (!try_push(lmstl::move(val)))
+			std::this_thread::yield();
+	}
+
+	//最多放入n个元素，返回实际放入的个数
+	template <typename InputIter>
+	size_type push_n(InputIter beg, size_type n) {
+		const size_type t = tail.load(std::memory_order_relaxed);
+		size_type room = capacity() - (t - head_cache);
+		if (room < n) {
+			head_cache = head.load(std::memory_order_acquire);
+			room = capacity() - (t - head_cache);
+		}
+		if (n > room)
+			n = room;
+		size_type i = 0;
+		try {
+			for (; i != n; ++i, ++beg)
+				new((void*)(buf + ((t + i) & mask))) T(*beg);
+		}
+		catch (...) {
+			tail.store(t + i, std::memory_order_release);
+			throw;
+		}
+		tail.store(t + n, std::memory_order_release);
+		return n;
+	}
+
+	//消费者调用
+	bool try_pop(value_type& out) {
+		const size_type h = head.load(std::memory_order_relaxed);
+		if (h == tail_cache) {
+			tail_cache = tail.load(std::memory_order_acquire);
+			if (h == tail_cache)
+				return false;
+		}
+		T* p = buf + (h & mask);
+		out = lmstl::move(*p);
+		destroy(p);
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	//队列空时自旋等待
+	void pop(value_type& out) {
+		while (!try_pop(out))
+			std::this_thread::yield();
+	}
+
+	//队头元素的指针，队列空时为0，元素在pop之前一直有效
+	value_type* front() {
+		const size_type h = head.load(std::memory_order_relaxed);
+		if (h == tail_cache) {
+			tail_cache = tail.load(std::memory_order_acquire);
+			if (h == tail_cache)
+				return 0;
+		}
+		return buf + (h & mask);
+	}
+
+	//丢弃队头元素，只能在front()返回非0之后调用
+	void pop() {
+		const size_type h = head.load(std::memory_order_relaxed);
+		destroy(buf + (h & mask));
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	//最多取出n个元素写到out，返回实际取出的个数
+	template <typename OutputIter>
+	size_type pop_n(OutputIter out, size_type n) {
+		const size_type h = head.load(std::memory_order_relaxed);
+		size_type avail = tail_cache - h;
+		if (avail < n) {
+			tail_cache = tail.load(std::memory_order_acquire);
+			avail = tail_cache - h;
+		}
+		if (n > avail)
+			n = avail;
+		size_type i = 0;
+		try {
+			for (; i != n; ++i, ++out) {
+				T* p = buf + ((h + i) & mask);
+				*out = lmstl::move(*p);
+				destroy(p);
+			}
+		}
+		catch (...) {
+			//第i个元素赋值失败时还留在队列里，只发布已经取走的部分
+			head.store(h + i, std::memory_order_release);
+			throw;
+		}
+		head.store(h + n, std::memory_order_release);
+		return n;
+	}
+};
+
+}
+#endif // !__LMSTL_SPSC_QUEUE_H__
@@ -21,11 +21,16 @@ protected:
 public:
 	stack():
 		c(){}
+	explicit stack(const Sequence& s):
+		c(s) {}
+	explicit stack(Sequence&& s):
+		c(lmstl::move(s)) {}
 	bool empty() const { return c.empty(); }
 	size_type size() const { return c.size(); }
 	reference top() { return c.back(); }
 	const_reference top() const { return c.back(); }
 	void push(const value_type& val) { c.push_back(val); }
+	void push(value_type&& val) { c.push_back(lmstl::move(val)); }
 	void pop() { c.pop_back(); }
 };
 
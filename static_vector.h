@@ -0,0 +1,290 @@
+#ifndef __LMSTL_STATIC_VECTOR_H__
+#define __LMSTL_STATIC_VECTOR_H__
+
+#include "iterator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "type_traits.h"
+#include "utility.h"
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <stddef.h>
+
+namespace lmstl {
+
+//static_vector的存储：都是未初始化的缓冲区，构造容器是O(1)，元素用placement new逐个构造
+//元素可平凡复制时复制、移动、析构都用默认的版本，整个容器也是可平凡复制的
+template <typename T, size_t N, bool = std::is_trivially_copyable<T>::value>
+class __static_vector_base {
+protected:
+	alignas(T) unsigned char buf[sizeof(T) * N];
+	size_t count;
+
+	__static_vector_base():
+		count(0) {}
+
+	T* ptr() noexcept { return reinterpret_cast<T*>(buf); }
+	const T* ptr() const noexcept { return reinterpret_cast<const T*>(buf); }
+
+	template <typename... Args>
+	void put(size_t i, Args&&... args) { new(ptr() + i) T(lmstl::forward<Args>(args)...); }
+	void kill(size_t) noexcept {}
+};
+
+template <typename T, size_t N>
+class __static_vector_base<T, N, false> {
+protected:
+	alignas(T) unsigned char buf[sizeof(T) * N];
+	size_t count;
+
+	__static_vector_base():
+		count(0) {}
+	__static_vector_base(const __static_vector_base& x):
+		count(0) {
+		for (; count != x.count; ++count)
+			put(count, x.ptr()[count]);
+	}
+	__static_vector_base(__static_vector_base&& x):
+		count(0) {
+		for (; count != x.count; ++count)
+			put(count, lmstl::move(x.ptr()[count]));
+	}
+	__static_vector_base& operator=(const __static_vector_base& x) {
+		if (this != &x) {
+			for (; count; --count)
+				kill(count - 1);
+			for (; count != x.count; ++count)
+				put(count, x.ptr()[count]);
+		}
+		return *this;
+	}
+	__static_vector_base& operator=(__static_vector_base&& x) {
+		if (this != &x) {
+			for (; count; --count)
+				kill(count - 1);
+			for (; count != x.count; ++count)
+				put(count, lmstl::move(x.ptr()[count]));
+		}
+		return *this;
+	}
+	~__static_vector_base() {
+		for (; count; --count)
+			kill(count - 1);
+	}
+
+	T* ptr() noexcept { return reinterpret_cast<T*>(buf); }
+	const T* ptr() const noexcept { return reinterpret_cast<const T*>(buf); }
+
+	template <typename... Args>
+	void put(size_t i, Args&&... args) { new(ptr() + i) T(lmstl::forward<Args>(args)...); }
+	void kill(size_t i) noexcept { destroy(ptr() + i); }
+};
+
+//容量固定为N、从不分配内存的vector，接口与vector相同，超出容量时抛出异常
+template <typename T, size_t N>
+class static_vector : private __static_vector_base<T, N> {
+	static_assert(N > 0, "static_vector needs a non-zero capacity");
+
+public:
+	typedef T					value_type;
+	typedef value_type*			pointer;
+	typedef const value_type*	const_pointer;
+	typedef value_type&			reference;
+	typedef const value_type&	const_reference;
+	typedef ptrdiff_t			difference_type;
+	typedef size_t				size_type;
+
+	typedef value_type*			iterator;
+	typedef const value_type*	const_iterator;
+	typedef reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef reverse_iterator<iterator> reverse_iterator;
+
+private:
+	typedef __static_vector_base<T, N> base;
+	using base::count;
+	using base::ptr;
+	using base::put;
+	using base::kill;
+
+public:
+	static_vector() {}
+	static_vector(size_type n, const T& val) {
+		__THROW_OUT_OF_RANGE_ERROR(n > N, "static_vector capacity exceeded");
+		for (; count != n; ++count)
+			put(count, val);
+	}
+	explicit static_vector(size_type n) {
+		__THROW_OUT_OF_RANGE_ERROR(n > N, "static_vector capacity exceeded");
+		for (; count != n; ++count)
+			put(count);
+	}
+
+	template <typename InputIter, typename = typename enable_if<
+		is_input_iterator_v<InputIter>>::type>
+	static_vector(InputIter beg, InputIter end) {
+		for (; beg != end; ++beg) {
+			__THROW_OUT_OF_RANGE_ERROR(count == N, "static_vector capacity exceeded");
+			put(count++, *beg);
+		}
+	}
+
+public:
+
+	iterator begin() noexcept { return ptr(); }
+	const_iterator begin() const noexcept { return ptr(); }
+	const_iterator cbegin() const noexcept { return ptr(); }
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+	iterator end() noexcept { return ptr() + count; }
+	const_iterator end() const noexcept { return ptr() + count; }
+	const_iterator cend() const noexcept { return ptr() + count; }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+	size_type size() const noexcept { return count; }
+	static constexpr size_type capacity() noexcept { return N; }
+	static constexpr size_type max_size() noexcept { return N; }
+	bool empty() const noexcept { return count == 0; }
+	bool full() const noexcept { return count == N; }
+
+	pointer data() noexcept { return ptr(); }
+	const_pointer data() const noexcept { return ptr(); }
+
+	void swap(static_vector& x) {
+		static_vector tmp(lmstl::move(x));
+		x = lmstl::move(*this);
+		*this = lmstl::move(tmp);
+	}
+
+	reference operator[](size_type n) {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return ptr()[n];
+	}
+	const_reference operator[](size_type n) const {
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return ptr()[n];
+	}
+
+	reference at(size_type n) {
+		__THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return ptr()[n];
+	}
+	const_reference at(size_type n) const {
+		__THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		return ptr()[n];
+	}
+
+	reference unchecked_at(size_type n) noexcept { return ptr()[n]; }
+	const_reference unchecked_at(size_type n) const noexcept { return ptr()[n]; }
+
+	reference front() noexcept { return ptr()[0]; }
+	const_reference front() const noexcept { return ptr()[0]; }
+	reference back() noexcept { return ptr()[count - 1]; }
+	const_reference back() const noexcept { return ptr()[count - 1]; }
+
+	void push_back(const T& val) {
+		__THROW_OUT_OF_RANGE_ERROR(count == N, "static_vector capacity exceeded");
+		put(count, val);
+		++count;
+	}
+
+	void push_back(T&& val) {
+		__THROW_OUT_OF_RANGE_ERROR(count == N, "static_vector capacity exceeded");
+		put(count, lmstl::move(val));
+		++count;
+	}
+
+	template <typename... Args>
+	void emplace_back(Args&&... args) {
+		__THROW_OUT_OF_RANGE_ERROR(count == N, "static_vector capacity exceeded");
+		put(count, lmstl::forward<Args>(args)...);
+		++count;
+	}
+
+	void pop_back() {
+		__THROW_RUNTIME_ERROR(empty(), "pop_back on empty static_vector");
+		--count;
+		kill(count);
+	}
+
+	iterator erase(iterator xbeg, iterator xend) {
+		__THROW_OUT_OF_RANGE_ERROR(!(xbeg <= xend && xbeg >= begin() && xend <= end()), "Range Error");
+		iterator p = xbeg;
+		for (iterator q = xend; q != end(); ++p, ++q)
+			*p = lmstl::move(*q);
+		const size_type new_count = p - begin();
+		for (; count != new_count; --count)
+			kill(count - 1);
+		return xbeg;
+	}
+	iterator erase(iterator pos) {
+		__THROW_OUT_OF_RANGE_ERROR((pos >= end() || pos < begin()), "Range Error");
+		return erase(pos, pos + 1);
+	}
+
+	void clear() noexcept {
+		for (; count; --count)
+			kill(count - 1);
+	}
+
+	template <typename... Args>
+	iterator emplace(iterator pos, Args&&... args) {
+		__THROW_OUT_OF_RANGE_ERROR(count == N, "static_vector capacity exceeded");
+		const size_type idx = pos - begin();
+		T val(lmstl::forward<Args>(args)...);
+		open_gap(idx, 1);
+		fill_gap(idx, lmstl::move(val), count);
+		++count;
+		return begin() + idx;
+	}
+	iterator insert(iterator pos, const value_type& val) {
+		return emplace(pos, val);
+	}
+	iterator insert(iterator pos, value_type&& val) {
+		return emplace(pos, lmstl::move(val));
+	}
+	iterator insert(iterator pos, size_type n, const T& val) {
+		__THROW_OUT_OF_RANGE_ERROR(n > N - count, "static_vector capacity exceeded");
+		const size_type idx = pos - begin();
+		T val_copy = val;
+		open_gap(idx, n);
+		for (size_type i = idx; i != idx + n; ++i)
+			fill_gap(i, val_copy, count);
+		count += n;
+		return begin() + idx;
+	}
+
+	template <typename InputIterator, typename = typename enable_if<is_input_iterator_v<InputIterator>>::type>
+	void insert(iterator pos, InputIterator beg, InputIterator end) {
+		const size_type len = (size_type)lmstl::distance(beg, end);
+		__THROW_OUT_OF_RANGE_ERROR(len > N - count, "static_vector capacity exceeded");
+		const size_type idx = pos - begin();
+		open_gap(idx, len);
+		for (size_type i = idx; beg != end; ++beg, ++i)
+			fill_gap(i, *beg, count);
+		count += len;
+	}
+
+private:
+	//把[idx, count)整体后移n位，落在原有元素之外的位置是未初始化内存，需要构造而不是赋值
+	void open_gap(size_type idx, size_type n) {
+		for (size_type i = count + n; i != idx + n; --i) {
+			if (i - 1 >= count)
+				put(i - 1, lmstl::move(ptr()[i - 1 - n]));
+			else
+				ptr()[i - 1] = lmstl::move(ptr()[i - 1 - n]);
+		}
+	}
+	template <typename U>
+	void fill_gap(size_type i, U&& val, size_type old_count) {
+		if (i >= old_count)
+			put(i, lmstl::forward<U>(val));
+		else
+			ptr()[i] = lmstl::forward<U>(val);
+	}
+};
+
+}
+#endif // !__LMSTL_STATIC_VECTOR_H__
@@ -92,6 +92,18 @@ static size_t API_TEST_FAIL;
 	cout<<CYAN<<"---------------------------------------------------------\n";	\
 }while(0)
 
+//没有对应的std容器可比较时，直接检查一个条件
+#define API_CHECK(name, cond) do{	\
+	cout<<"TESTING "<<name<<": "<<endl;	\
+	if(cond){	\
+		cout<<GREEN<<"PASS"<<endl;	\
+		API_TEST_PASS++;}	\
+	else{	\
+		cout<<RED<<"FAIL"<<endl;	\
+		API_TEST_FAIL++;}	\
+	cout<<CYAN<<"---------------------------------------------------------\n";	\
+}while(0)
+
 #define API_TEST01(myctn, stdctn, func, arg) do{	\
 	cout<<"TESTING "<<#func<<": "<<endl;	\
 	myctn.func(arg);	\
@@ -191,7 +203,7 @@ static size_t API_TEST_FAIL;
 	for(size_t i=0;i<len;++i)	\
 		xctn.func(tv[i]);	\
 	end = clock();	\
-	tv.~vector();	\
+	decltype(tv)().swap(tv);	\
 	int n = (int)(static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000);	\
 	char outstring[20];	\
 	std::snprintf(outstring, sizeof(outstring), "%d", n);	\
@@ -210,7 +222,7 @@ static size_t API_TEST_FAIL;
 	for(size_t i=0;i<len;++i)	\
 		xctn.func(xctn.funcarg(), tv[i]);	\
 	end = clock();	\
-	tv.~vector();	\
+	decltype(tv)().swap(tv);	\
 	int n = (int)(static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000);	\
 	char outstring[20];	\
 	std::snprintf(outstring, sizeof(outstring), "%d", n);	\
@@ -245,6 +257,27 @@ static size_t API_TEST_FAIL;
 	cout << endl;\
 }while(0)
 
+//lmstl容器使用指定的分配器，每个长度用一个新容器计时，包含扩容的开销
+#define PERF_TEST01(ctn, myalloc, func, len1, len2, len3) do{	\
+	cout << "|---------------------|-------------|-------------|-------------|\n";	\
+	std::string name(#func);	\
+	name += "      |";	\
+	cout << "|"<<std::setw(WIDE2)<< name;	\
+	std::string l1(#len1), l2(#len2), l3(#len3);	\
+	l1+="   |";l2+="   |";l3+="   |";	\
+	std::string aname(#myalloc);	\
+	aname += "   |";	\
+	cout<<std::setw(WIDE)<<l1<<std::setw(WIDE)<<l2<<std::setw(WIDE)<<l3<<"\n|"<<std::setw(WIDE2)<<aname;	\
+	{ lmstl::ctn<int, lmstl::myalloc> myctn; TIMING00(myctn, func, len1); }	\
+	{ lmstl::ctn<int, lmstl::myalloc> myctn; TIMING00(myctn, func, len2); }	\
+	{ lmstl::ctn<int, lmstl::myalloc> myctn; TIMING00(myctn, func, len3); }	\
+	cout<<"\n|         std         |";	\
+	{ std::ctn<int> stdctn; TIMING00(stdctn, func, len1); }	\
+	{ std::ctn<int> stdctn; TIMING00(stdctn, func, len2); }	\
+	{ std::ctn<int> stdctn; TIMING00(stdctn, func, len3); }	\
+	cout << endl;\
+}while(0)
+
 #define MAPTIMING1(xctn, func, len, ns) do{	\
 	clock_t start, end;	\
 	std::vector<ns::pair<int, int>> tv;	\
@@ -255,7 +288,7 @@ static size_t API_TEST_FAIL;
 	for(size_t i=0;i<len;++i)	\
 		xctn.func(tv[i]);	\
 	end = clock();	\
-	tv.~vector();	\
+	decltype(tv)().swap(tv);	\
 	int n = (int)(static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000);	\
 	char outstring[20];	\
 	std::snprintf(outstring, sizeof(outstring), "%d", n);	\
@@ -274,7 +307,7 @@ static size_t API_TEST_FAIL;
 	for(size_t i=0;i<len;++i)	\
 		xctn[tv[i]]=i;	\
 	end = clock();	\
-	tv.~vector();	\
+	decltype(tv)().swap(tv);	\
 	int n = (int)(static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000);	\
 	char outstring[20];	\
 	std::snprintf(outstring, sizeof(outstring), "%d", n);	\
@@ -0,0 +1,178 @@
+#ifndef __LMSTL_TIMER_WHEEL_H__
+#define __LMSTL_TIMER_WHEEL_H__
+
+#include "alloc.h"
+#include "vector.h"
+#include "bit_vector.h"
+#include "functional.h"
+#include "exceptdef.h"
+#include "utility.h"
+#include <stdexcept>
+#include <type_traits>
+#include <stddef.h>
+
+namespace lmstl {
+
+//分层时间轮：键是无符号整数时间戳，按时间先后弹出，push的时间不能早于当前时间now()（最后一次pop出的时间）
+//每层2^SlotBits个槽，第l层的槽号是时间的第l组SlotBits位；时间t放在t与now最高的不同位所在的层，
+//所以0层每个槽里的时间都相同，高层的槽在now走到它时整体下放到低层
+//每层用一个64位的位图记录非空槽，找最早的槽只要一次位扫描；push是O(1)，每个元素最多下放层数次
+template <typename T, typename KeyOfValue = identity<T>, size_t SlotBits = 6, typename Alloc = alloc>
+class timer_wheel {
+public:
+	typedef T					value_type;
+	typedef const T&			const_reference;
+	typedef size_t				size_type;
+	typedef KeyOfValue			key_extractor;
+	typedef typename std::decay<decltype(KeyOfValue()(std::declval<const T&>()))>::type key_type;
+
+	static_assert(std::is_unsigned<key_type>::value && sizeof(key_type) <= sizeof(bit_word),
+		"timer_wheel needs an unsigned integer key of at most 64 bits");
+	static_assert(SlotBits >= 1 && (size_t(1) << SlotBits) <= __BIT_WORD_BITS,
+		"timer_wheel slots of a level must fit in one bitmap word");
+
+	static constexpr size_type slots_per_level = size_type(1) << SlotBits;
+	static constexpr size_type levels = (sizeof(key_type) * 8 + SlotBits - 1) / SlotBits;
+
+private:
+	typedef vector<T, Alloc> slot;
+	static constexpr size_type npos = size_type(-1);
+	static constexpr size_type slot_mask = slots_per_level - 1;
+
+	vector<slot> wheel;		//第l层第s个槽是wheel[l * slots_per_level + s]
+	slot scratch;
+	bit_word occupied[levels];
+	key_type cur;
+	size_type count;
+	KeyOfValue key;
+
+	//最低非空层（不是0层时）最早的槽里最小元素的位置，npos表示需要重新扫描
+	mutable size_type min_slot;
+	mutable size_type min_pos;
+
+public:
+	timer_wheel():
+		wheel(levels * slots_per_level), cur(0), count(0), min_slot(0), min_pos(npos) {
+		for (size_type l = 0; l != levels; ++l)
+			occupied[l] = 0;
+	}
+	explicit timer_wheel(key_type start, const KeyOfValue& k = KeyOfValue()):
+		timer_wheel() {
+		cur = start;
+		key = k;
+	}
+
+	bool empty() const { return count == 0; }
+	size_type size() const { return count; }
+	//当前时间，之后push的时间不能比它早
+	key_type now() const { return cur; }
+
+	const_reference top() const {
+		if (occupied[0])
+			return wheel[__lowest_bit(occupied[0])].back();
+		locate_min();
+		return wheel[min_slot][min_pos];
+	}
+
+	void push(const value_type& val) { put(val); }
+	void push(value_type&& val) { put(lmstl::move(val)); }
+	template <typename... Args>
+	void emplace(Args&&... args) { put(value_type(lmstl::forward<Args>(args)...)); }
+
+	void pop() {
+		__THROW_RUNTIME_ERROR(empty(), "pop on empty timer_wheel");
+		if (!occupied[0])
+			cascade();
+		const size_type s = __lowest_bit(occupied[0]);
+		slot& sl = wheel[s];
+		cur = key(sl.back());
+		sl.pop_back();
+		if (sl.empty())
+			occupied[0] &= ~(bit_word(1) << s);
+		--count;
+	}
+
+	void clear() {
+		for (size_type i = 0; i != wheel.size(); ++i)
+			wheel[i].clear();
+		for (size_type l = 0; l != levels; ++l)
+			occupied[l] = 0;
+		count = 0;
+		min_pos = npos;
+	}
+
+private:
+	size_type level_of(key_type t) const {
+		return t == cur ? 0 : __highest_bit(bit_word(t ^ cur)) / SlotBits;
+	}
+	static size_type slot_of(key_type t, size_type l) {
+		return l * slots_per_level + ((bit_word(t) >> (l * SlotBits)) & slot_mask);
+	}
+
+	template <typename U>
+	void put(U&& val) {
+		const key_type t = key(val);
+		__THROW_RUNTIME_ERROR(t < cur, "timer_wheel time is earlier than now()");
+		const size_type l = level_of(t);
+		const size_type s = slot_of(t, l);
+		wheel[s].push_back(lmstl::forward<U>(val));
+		occupied[l] |= bit_word(1) << (s & slot_mask);
+		++count;
+		if (l && min_pos != npos) {
+			if (s < min_slot)
+				min_pos = npos;
+			else if (s == min_slot && t < key(wheel[s][min_pos]))
+				min_pos = wheel[s].size() - 1;
+		}
+	}
+
+	//0层为空时调用：最低非空层最早的槽
+	size_type earliest_slot() const {
+		size_type l = 1;
+		while (!occupied[l])
+			++l;
+		return l * slots_per_level + __lowest_bit(occupied[l]);
+	}
+
+	void locate_min() const {
+		const size_type s = earliest_slot();
+		if (min_pos != npos && min_slot == s)
+			return;
+		const slot& sl = wheel[s];
+		size_type pos = 0;
+		for (size_type i = 1; i < sl.size(); ++i)
+			if (key(sl[i]) < key(sl[pos]))
+				pos = i;
+		min_slot = s;
+		min_pos = pos;
+	}
+
+	//把时间推进到最早的槽中的最小时间，这个槽的元素全部下放到更低的层
+	//top()给出的最小元素最后放进0层的槽，时间相同时pop弹出的就是top()返回的那个
+	void cascade() {
+		locate_min();
+		const size_type s = min_slot;
+		const size_type m = min_pos;
+		const size_type l = s / slots_per_level;
+		cur = key(wheel[s][m]);
+		min_pos = npos;
+		scratch.swap(wheel[s]);
+		occupied[l] &= ~(bit_word(1) << (s & slot_mask));
+		for (size_type i = 0; i != scratch.size(); ++i) {
+			if (i == m)
+				continue;
+			const key_type t = key(scratch[i]);
+			const size_type nl = level_of(t);
+			const size_type ns = slot_of(t, nl);
+			wheel[ns].push_back(lmstl::move(scratch[i]));
+			occupied[nl] |= bit_word(1) << (ns & slot_mask);
+		}
+		const size_type ns = slot_of(cur, 0);
+		wheel[ns].push_back(lmstl::move(scratch[m]));
+		occupied[0] |= bit_word(1) << ns;
+		scratch.clear();
+	}
+};
+
+}
+#endif // !__LMSTL_TIMER_WHEEL_H__
@@ -1,6 +1,8 @@
 #ifndef __LMSTL_TYPE_TRAITS_H__
 #define __LMSTL_TYPE_TRAITS_H__
 
+#include <type_traits>
+
 namespace lmstl {
 
 template <class... _Types>
@@ -30,6 +32,14 @@ struct enable_if<true, T> {
 	typedef T type;
 };
 
+//把对象按位搬到新地址并放弃旧对象，等价于移动构造后析构旧对象
+//默认只对可按位复制的类型成立，自定义类型（如只持有指针的句柄）可特化为true_type
+template <typename T>
+struct is_trivially_relocatable : lm_bool_constant<std::is_trivially_copyable<T>::value> {};
+
+template <typename T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
 }
 
 #endif // !__LMSTL_TYPE_TRAITS_H__
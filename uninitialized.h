@@ -4,11 +4,18 @@
 #include "iterator.h"
 #include "construct.h"
 #include "algobase.h"
+#include "type_traits.h"
 #include <type_traits>
 #include <cstring>
 
 namespace lmstl {
 
+//T可平凡复制，且用Arg赋值是平凡的，才能把未初始化内存上的构造换成copy/fill的赋值（内部可走memmove/memset）
+//只判断可平凡复制不够：赋值运算符可以被删除
+template <typename T, typename Arg>
+struct __assign_as_construct: std::integral_constant<bool,
+	std::is_trivially_copyable<T>::value && std::is_trivially_assignable<T&, Arg>::value> {};
+
 template <typename ForwardIterator, typename size, typename T>
 inline ForwardIterator __uninitialized_fill_n(ForwardIterator beg, size n, const T& x, std::true_type) {
 	return lmstl::fill_n(beg, n, x);
@@ -24,7 +31,8 @@ inline ForwardIterator __uninitialized_fill_n(ForwardIterator beg, size n, const
 
 template <typename ForwardIterator, typename size, typename T>
 inline ForwardIterator uninitialized_fill_n(ForwardIterator beg, size n, const T& x) {
-	return __uninitialized_fill_n(beg, n, x, std::is_pod<T>());
+	typedef typename iterator_traits<ForwardIterator>::value_type value_type;
+	return __uninitialized_fill_n(beg, n, x, __assign_as_construct<value_type, const T&>());
 }
 
 template <typename InputIterator, typename ForwardIterator>
@@ -42,8 +50,9 @@ inline ForwardIterator __uninitialized_copy_n(InputIterator beg, InputIterator e
 
 template <typename InputIterator, typename ForwardIterator>
 inline ForwardIterator uninitialized_copy(InputIterator beg, InputIterator end, ForwardIterator dest) {
-	typedef iterator_traits<InputIterator>::value_type value_type;
-	return __uninitialized_copy_n(beg, end, dest, std::is_pod<value_type>());
+	typedef typename iterator_traits<ForwardIterator>::value_type value_type;
+	typedef typename iterator_traits<InputIterator>::reference reference;
+	return __uninitialized_copy_n(beg, end, dest, __assign_as_construct<value_type, reference>());
 }
 
 template<>
@@ -73,7 +82,8 @@ inline ForwardIter uninitialized_move_aux(InputIter beg, InputIter end, ForwardI
 
 template <typename InputIter, typename ForwardIter>
 inline ForwardIter uninitialized_move(InputIter beg, InputIter end, ForwardIter dest) {
-	typedef std::is_trivially_move_assignable<typename iterator_traits<InputIter>::value_type> mt;
+	typedef __assign_as_construct<typename iterator_traits<ForwardIter>::value_type,
+		typename iterator_traits<InputIter>::value_type&&> mt;
 	return uninitialized_move_aux(beg, end, dest, mt());
 }
 
@@ -91,7 +101,8 @@ inline ForwardIter uninitialized_move_n_aux(InputIter beg, size_t n, ForwardIter
 
 template <typename InputIter, typename ForwardIter>
 inline ForwardIter uninitialized_move_n(InputIter beg, size_t n, ForwardIter dest) {
-	typedef std::is_trivially_move_assignable<typename iterator_traits<InputIter>::value_type> mt;
+	typedef __assign_as_construct<typename iterator_traits<ForwardIter>::value_type,
+		typename iterator_traits<InputIter>::value_type&&> mt;
 	return uninitialized_move_n_aux(beg, n, dest, mt());
 }
 
@@ -122,8 +133,41 @@ inline void __uninitialized_fill(ForwardIterator beg, ForwardIterator end, const
 
 template <typename ForwardIterator, typename T>
 inline void uninitialized_fill(ForwardIterator beg, ForwardIterator end, const T& val) {
-	typedef iterator_traits<ForwardIterator>::value_type value_type;
-	__uninitialized_fill(beg, end, val, std::is_pod<value_type>());
+	typedef typename iterator_traits<ForwardIterator>::value_type value_type;
+	__uninitialized_fill(beg, end, val, __assign_as_construct<value_type, const T&>());
+}
+
+//把[beg, end)中的对象搬到dest开始的未初始化内存，并结束源对象的生命期
+//可平凡重定位的元素整块memmove，否则逐个移动构造后析构；源与目的可以重叠
+template <typename T>
+inline T* __uninitialized_relocate(T* beg, T* end, T* dest, true_type) {
+	const size_t n = static_cast<size_t>(end - beg);
+	if (n)
+		std::memmove((void*)dest, (const void*)beg, n * sizeof(T));
+	return dest + n;
+}
+
+template <typename T>
+inline T* __uninitialized_relocate(T* beg, T* end, T* dest, false_type) {
+	//dest落在源区间内时从后往前搬，保证每个源对象在被覆盖之前已经搬走
+	if (dest > beg && dest < end) {
+		T* ret = dest + (end - beg);
+		for (T* d = ret; end != beg; ) {
+			construct(--d, lmstl::move(*--end));
+			destroy(end);
+		}
+		return ret;
+	}
+	for (; beg != end; ++beg, ++dest) {
+		construct(dest, lmstl::move(*beg));
+		destroy(beg);
+	}
+	return dest;
+}
+
+template <typename T>
+inline T* uninitialized_relocate(T* beg, T* end, T* dest) {
+	return __uninitialized_relocate(beg, end, dest, is_trivially_relocatable<T>());
 }
 
 }
@@ -92,5 +92,9 @@ struct pair {
 	}
 };
 
+template <typename T1, typename T2>
+struct is_trivially_relocatable<pair<T1, T2>> :
+	lm_bool_constant<is_trivially_relocatable<T1>::value && is_trivially_relocatable<T2>::value> {};
+
 }
 #endif // !__LMSTL_UTILITY_H__
@@ -11,8 +11,38 @@
 
 namespace lmstl {
 
-template <typename T, typename Alloc = alloc>
-class vector {
+static const size_t __VECTOR_INIT_SIZE = 10;
+
+//扩容策略：next(cap, need, elem_size)在容量cap放不下need个元素时给出新容量，结果不小于need
+template <size_t Num, size_t Den>
+struct geometric_growth {
+	static_assert(Num > Den && Den > 0, "growth factor must be greater than 1");
+	static size_t next(size_t cap, size_t need, size_t) {
+		size_t n = cap ? cap + cap / Den * (Num - Den) + cap % Den * (Num - Den) / Den : __VECTOR_INIT_SIZE;
+		return n > need ? n : need;
+	}
+};
+
+typedef geometric_growth<2, 1> growth_2x;
+typedef geometric_growth<3, 2> growth_1_5x;
+
+//超过Threshold字节后把容量向上取整到整页，大块内存直接来自mmap时不浪费尾页
+template <typename Base = growth_2x, size_t PageBytes = 4096, size_t Threshold = 64 * 1024>
+struct page_rounded_growth {
+	static_assert((PageBytes & (PageBytes - 1)) == 0, "PageBytes must be a power of 2");
+	static size_t next(size_t cap, size_t need, size_t elem_size) {
+		size_t n = Base::next(cap, need, elem_size);
+		size_t bytes = n * elem_size;
+		if (bytes < Threshold)
+			return n;
+		return ((bytes + PageBytes - 1) & ~(PageBytes - 1)) / elem_size;
+	}
+};
+
+typedef growth_2x default_growth;
+
+template <typename T, typename Alloc = alloc, typename Growth = default_growth>
+class vector : private alloc_holder<Alloc> {
 
 public:
 	typedef T					value_type;
@@ -27,28 +57,35 @@ public:
 	typedef const value_type*	const_iterator;
 	typedef reverse_iterator<const_iterator> const_reverse_iterator;
 	typedef reverse_iterator<iterator> reverse_iterator;
+	typedef Alloc				allocator_type;
+	typedef Growth				growth_policy;
 
 public:
 	vector():
 		start(0), finish(0), end_of_storage(0) {}
-	vector(size_type n, const T& val) {
-		start = data_allocator::allocate(n);
+	explicit vector(const Alloc& a):
+		alloc_base(a), start(0), finish(0), end_of_storage(0) {}
+	vector(size_type n, const T& val, const Alloc& a = Alloc()):
+		alloc_base(a) {
+		start = data_allocator::allocate(this->get_alloc(), n);
 		lmstl::uninitialized_fill_n(start, n, val);
 		finish = end_of_storage = start + n;
 	}
-	explicit vector(size_type n) {
-		start = data_allocator::allocate(n);
+	explicit vector(size_type n, const Alloc& a = Alloc()):
+		alloc_base(a) {
+		start = data_allocator::allocate(this->get_alloc(), n);
 		lmstl::uninitialized_fill_n(start, n, T());
 		finish = end_of_storage = start + n;
 	}
-	vector(const vector& x) {
+	vector(const vector& x):
+		alloc_base(x.get_alloc()) {
 		size_type cap = (size_type)(x.end_of_storage - x.start);
 		size_type sz = (size_type)(x.finish - x.start);
 		init(sz, cap);
 		lmstl::uninitialized_copy(x.begin(), x.end(), start);
 	}
 	vector(vector&& x) noexcept :
-		start(x.start), finish(x.finish), end_of_storage(x.end_of_storage) {
+		alloc_base(lmstl::move(x.get_alloc())), start(x.start), finish(x.finish), end_of_storage(x.end_of_storage) {
 		x.start = 0;
 		x.finish = 0;
 		x.end_of_storage = 0;
@@ -56,27 +93,38 @@ public:
 
 	template <typename InputIter, typename = typename enable_if<
 		is_input_iterator_v<InputIter>>::type>
-	vector(InputIter beg, InputIter end) {
-		size_type sz = distance(beg, end);
+	vector(InputIter beg, InputIter end, const Alloc& a = Alloc()):
+		alloc_base(a) {
+		size_type sz = lmstl::distance(beg, end);
 		init(sz, sz);
 		lmstl::uninitialized_copy(beg, end, start);
 	}
 
 	~vector() {
 		destroy(start, finish);
-		data_allocator::deallocate(start, capacity());
+		data_allocator::deallocate(this->get_alloc(), start, capacity());
 	}
 
+	allocator_type get_allocator() const { return this->get_alloc(); }
+
 protected:
+	typedef alloc_holder<Alloc> alloc_base;
 	typedef simple_alloc<value_type, Alloc> data_allocator;
 	iterator start;
 	iterator finish;
 	iterator end_of_storage;
 
 private:
+	//还要再放n个元素时按扩容策略得到的新容量
+	size_type next_capacity(size_type n) const {
+		return Growth::next(capacity(), size() + n, sizeof(T));
+	}
+
+	void reallocate_storage(size_type n);
+
 	void init(size_type sz, size_type cap) {
 		try {
-			start = data_allocator::allocate(cap);
+			start = data_allocator::allocate(this->get_alloc(), cap);
 			finish = start + sz;
 			end_of_storage = start + cap;
 		}
@@ -106,18 +154,22 @@ public:
 	size_type capacity() const noexcept { return size_type(end_of_storage - start); }
 	bool empty() const noexcept { return (start == finish); }
 
-	void swap(vector<T, Alloc>& x) {
+	pointer data() noexcept { return start; }
+	const_pointer data() const noexcept { return start; }
+
+	void swap(vector& x) {
 		lmstl::swap(start, x.start);
 		lmstl::swap(finish, x.finish);
 		lmstl::swap(end_of_storage, x.end_of_storage);
+		this->swap_alloc(x);
 	}
 
 	reference operator[](size_type n) {
-		__THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
 		return *(start + n);
 	}
 	const_reference operator[](size_type n) const {
-		__THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
+		__DEBUG_THROW_OUT_OF_RANGE_ERROR(n >= size(), "Index out of range");
 		return *(start + n);
 	}
 
@@ -130,6 +182,9 @@ public:
 		return *(start + n);
 	}
 
+	reference unchecked_at(size_type n) noexcept { return *(start + n); }
+	const_reference unchecked_at(size_type n) const noexcept { return *(start + n); }
+
 	reference front() noexcept { return *start; }
 	const_reference front() const noexcept { return *start; }
 	reference back() noexcept { return *(finish - 1); }
@@ -139,6 +194,8 @@ private:
 	iterator realloc_insert(iterator pos, const T& val);
 	template <typename... Args>
 	iterator realloc_emplace(iterator pos, Args&&... args);
+	template <typename U>
+	iterator realloc_relocate(iterator pos, U&& val, size_type new_size);
 
 public:
 
@@ -193,13 +250,24 @@ public:
 	}
 
 	void reserve(size_type n) {
-		start = data_allocator::allocate(n);
-		finish = start;
-		end_of_storage = start + n;
+		if (n > capacity())
+			reallocate_storage(n);
+	}
+
+	void shrink_to_fit() {
+		if (finish == end_of_storage)
+			return;
+		if (start == finish) {
+			data_allocator::deallocate(this->get_alloc(), start, capacity());
+			start = finish = end_of_storage = 0;
+			return;
+		}
+		reallocate_storage(size());
 	}
 
 	void clear() {
 		destroy(start, finish);
+		finish = start;
 	}
 
 	iterator insert(const iterator position, size_type n, const T& val);
@@ -229,8 +297,8 @@ public:
 		}
 		else {
 			size_type old_size = end_of_storage - start;
-			size_type new_size = old_size + max(old_size, len);
-			iterator new_start = data_allocator::allocate(new_size);
+			size_type new_size = next_capacity(len);
+			iterator new_start = data_allocator::allocate(this->get_alloc(), new_size);
 			iterator new_finish = new_start;
 			size_type diff = static_cast<size_type>(lmstl::distance(start, pos));
 			try {
@@ -240,12 +308,12 @@ public:
 			}
 			catch (...) {
 				destroy(new_start, new_finish);
-				data_allocator::deallocate(new_start, new_size);
+				data_allocator::deallocate(this->get_alloc(), new_start, new_size);
 				__THROW_RUNTIME_ERROR(1, "Error when reallocating");
 			}
 			if (start) {
 				destroy(start, finish);
-				data_allocator::deallocate(start, old_size);
+				data_allocator::deallocate(this->get_alloc(), start, old_size);
 			}
 			start = new_start;
 			finish = new_finish;
@@ -275,8 +343,8 @@ public:
 		}
 		else {
 			size_type old_size = end_of_storage - start;
-			size_type new_size = old_size + max(old_size, len);
-			iterator new_start = data_allocator::allocate(new_size);
+			size_type new_size = next_capacity(len);
+			iterator new_start = data_allocator::allocate(this->get_alloc(), new_size);
 			iterator new_finish = new_start;
 			size_type diff = static_cast<size_type>(lmstl::distance(start, pos));
 			try {
@@ -286,12 +354,12 @@ public:
 			}
 			catch (...) {
 				destroy(new_start, new_finish);
-				data_allocator::deallocate(new_start, new_size);
+				data_allocator::deallocate(this->get_alloc(), new_start, new_size);
 				__THROW_RUNTIME_ERROR(1, "Error when reallocating");
 			}
 			if (start) {
 				destroy(start, finish);
-				data_allocator::deallocate(start, old_size);
+				data_allocator::deallocate(this->get_alloc(), start, old_size);
 			}
 			start = new_start;
 			finish = new_finish;
@@ -300,19 +368,27 @@ public:
 	}	
 };
 
-template<typename T, typename Alloc>
-inline typename vector<T, Alloc>::iterator vector<T, Alloc>::realloc_insert(iterator pos, const T& val) {
+template <typename T, typename Alloc, typename Growth>
+inline typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::realloc_insert(iterator pos, const T& val) {
 	if(finish!=end_of_storage){
-		++finish;
 		T val_copy = val;
-		lmstl::move_backward(pos, finish - 1, finish);
-		*pos = val_copy;
+		if (pos == finish) {
+			construct(finish, lmstl::move(val_copy));
+			++finish;
+			return pos;
+		}
+		construct(finish, lmstl::move(*(finish - 1)));
+		++finish;
+		lmstl::move_backward(pos, finish - 2, finish - 1);
+		*pos = lmstl::move(val_copy);
 		return pos;
 	}
 	const size_type old_size = end_of_storage - start;
-	const size_type new_size = old_size ? (old_size << 1) : 10;
+	const size_type new_size = next_capacity(1);
+	if constexpr (is_trivially_relocatable<T>::value)
+		return realloc_relocate(pos, val, new_size);
 	iterator ret;
-	iterator new_start = data_allocator::allocate(new_size);
+	iterator new_start = data_allocator::allocate(this->get_alloc(), new_size);
 	iterator new_finish = new_start;
 	try {
 		ret = new_finish = lmstl::uninitialized_move(start, pos, new_start);
@@ -322,12 +398,12 @@ inline typename vector<T, Alloc>::iterator vector<T, Alloc>::realloc_insert(iter
 	}
 	catch (...) {
 		destroy(new_start, new_finish);
-		data_allocator::deallocate(new_start, new_size);
+		data_allocator::deallocate(this->get_alloc(), new_start, new_size);
 		__THROW_RUNTIME_ERROR(1, "Error when reallocating");
 	}
 	if (start) {
 		destroy(start, finish);
-		data_allocator::deallocate(start, old_size);
+		data_allocator::deallocate(this->get_alloc(), start, old_size);
 	}
 	start = new_start;
 	finish = new_finish;
@@ -335,8 +411,8 @@ inline typename vector<T, Alloc>::iterator vector<T, Alloc>::realloc_insert(iter
 	return ret;
 }
 
-template<typename T, typename Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(const iterator position, size_type n, const T& val) {
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(const iterator position, size_type n, const T& val) {
 	iterator pos = const_cast<iterator>(position);
 	if (!n) return pos;
 	if (size_type(end_of_storage - finish) >= n) {
@@ -356,9 +432,9 @@ typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(const iterator posi
 		return pos;
 	}
 	const size_type old_size = end_of_storage - start;
-	const size_type new_size = old_size + max(old_size, n);
+	const size_type new_size = next_capacity(n);
 	iterator ret;
-	iterator new_start = data_allocator::allocate(new_size);
+	iterator new_start = data_allocator::allocate(this->get_alloc(), new_size);
 	iterator new_finish = new_start;
 	try {
 		ret = new_finish = lmstl::uninitialized_move(start, pos, new_start);
@@ -367,12 +443,12 @@ typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(const iterator posi
 	}
 	catch (...) {
 		destroy(new_start, new_finish);
-		data_allocator::deallocate(new_start, new_size);
+		data_allocator::deallocate(this->get_alloc(), new_start, new_size);
 		__THROW_RUNTIME_ERROR(1, "Error when reallocating");
 	}
 	if (start) {
 		destroy(start, finish);
-		data_allocator::deallocate(start, old_size);
+		data_allocator::deallocate(this->get_alloc(), start, old_size);
 	}
 	start = new_start;
 	finish = new_finish;
@@ -380,13 +456,15 @@ typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(const iterator posi
 	return ret;
 }
 
-template <typename T, typename Alloc>
+template <typename T, typename Alloc, typename Growth>
 template <typename... Args>
-inline typename vector<T, Alloc>::iterator vector<T, Alloc>::realloc_emplace(iterator pos, Args&&... args) {
+inline typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::realloc_emplace(iterator pos, Args&&... args) {
 	const size_type old_size = end_of_storage - start;
-	const size_type new_size = old_size ? (old_size << 1) : 10;
+	const size_type new_size = next_capacity(1);
+	if constexpr (is_trivially_relocatable<T>::value)
+		return realloc_relocate(pos, T(lmstl::forward<Args>(args)...), new_size);
 	iterator ret;
-	iterator new_start = data_allocator::allocate(new_size);
+	iterator new_start = data_allocator::allocate(this->get_alloc(), new_size);
 	iterator new_finish = new_start;
 	try {
 		ret = new_finish = lmstl::uninitialized_move(start, pos, new_start);
@@ -396,12 +474,12 @@ inline typename vector<T, Alloc>::iterator vector<T, Alloc>::realloc_emplace(ite
 	}
 	catch (...) {
 		destroy(new_start, new_finish);
-		data_allocator::deallocate(new_start, new_size);
+		data_allocator::deallocate(this->get_alloc(), new_start, new_size);
 		__THROW_RUNTIME_ERROR(1, "Error when reallocating");
 	}
 	if (start) {
 		destroy(start, finish);
-		data_allocator::deallocate(start, old_size);
+		data_allocator::deallocate(this->get_alloc(), start, old_size);
 	}
 	start = new_start;
 	finish = new_finish;
@@ -409,5 +487,46 @@ inline typename vector<T, Alloc>::iterator vector<T, Alloc>::realloc_emplace(ite
 	return ret;
 }
 
+//可平凡重定位的元素经由分配器的reallocate扩容，分配器能原地扩展时省去整体复制，再用memmove空出插入位置
+template <typename T, typename Alloc, typename Growth>
+template <typename U>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::realloc_relocate(iterator pos, U&& val, size_type new_size) {
+	const size_type index = pos - start;
+	const size_type sz = finish - start;
+	T val_copy(lmstl::forward<U>(val));
+	start = data_allocator::reallocate(this->get_alloc(), start, size_type(end_of_storage - start), new_size);
+	lmstl::uninitialized_relocate(start + index, start + sz, start + index + 1);
+	construct(start + index, lmstl::move(val_copy));
+	finish = start + sz + 1;
+	end_of_storage = start + new_size;
+	return start + index;
+}
+
+//把元素搬到容量为n的新空间，可平凡重定位的元素交给分配器的reallocate
+template <typename T, typename Alloc, typename Growth>
+void vector<T, Alloc, Growth>::reallocate_storage(size_type n) {
+	const size_type sz = size();
+	if constexpr (is_trivially_relocatable<T>::value) {
+		start = data_allocator::reallocate(this->get_alloc(), start, capacity(), n);
+	}
+	else {
+		iterator new_start = data_allocator::allocate(this->get_alloc(), n);
+		try {
+			lmstl::uninitialized_move(start, finish, new_start);
+		}
+		catch (...) {
+			data_allocator::deallocate(this->get_alloc(), new_start, n);
+			__THROW_RUNTIME_ERROR(1, "Error when reallocating");
+		}
+		if (start) {
+			destroy(start, finish);
+			data_allocator::deallocate(this->get_alloc(), start, capacity());
+		}
+		start = new_start;
+	}
+	finish = start + sz;
+	end_of_storage = start + n;
+}
+
 }
 #endif // !__LMSTL_VECTOR_H__
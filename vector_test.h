@@ -3,11 +3,211 @@
 
 #include "test_frame.h"
 #include "vector.h"
+#include "uninitialized.h"
+#include "small_vector.h"
+#include "static_vector.h"
+#include "mmap_vector.h"
+#include "soa_vector.h"
+#include "bit_vector.h"
 #include <vector>
 #include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 
 namespace lmstl {
 
+//可平凡复制但不能赋值，未初始化内存上只能构造
+struct __no_assign {
+	int v;
+	explicit __no_assign(int x): v(x) {}
+	__no_assign(const __no_assign&) = default;
+	__no_assign& operator=(const __no_assign&) = delete;
+};
+
+//在一块缓冲区里把[0, n)重定位到[shift, shift + n)，源与目的重叠
+inline bool relocate_overlap(int n, int shift) {
+	std::allocator<std::string> a;
+	std::string* buf = a.allocate(n + 4);
+	std::string* src = shift >= 0 ? buf : buf - shift;
+	for (int i = 0; i < n; ++i)
+		construct(src + i, std::string(20, char('a' + i)));
+	std::string* dest = uninitialized_relocate(src, src + n, src + shift) - n;
+	bool ok = true;
+	for (int i = 0; i < n; ++i) {
+		ok = ok && dest[i] == std::string(20, char('a' + i));
+		destroy(dest + i);
+	}
+	a.deallocate(buf, n + 4);
+	return ok;
+}
+
+inline bool move_no_assign() {
+	__no_assign src[3] = { __no_assign(1), __no_assign(2), __no_assign(3) };
+	std::allocator<__no_assign> a;
+	__no_assign* dest = a.allocate(3);
+	uninitialized_move(src, src + 3, dest);
+	uninitialized_copy(src, src + 3, dest);
+	uninitialized_fill_n(dest, 3, src[1]);
+	bool ok = dest[0].v == 2 && dest[2].v == 2;
+	a.deallocate(dest, 3);
+	return ok;
+}
+
+//与vector接口相同的容器，和std::vector<int>做同样的操作后比较
+template <typename Vec>
+void vector_like_test(Vec& mv) {
+	std::vector<int> sv(mv.begin(), mv.end());
+	const int src[6] = { 9, 8, 7, 6, 5, 4 };
+	for (int i = 0; i < 5; ++i) {
+		mv.push_back(i);
+		sv.push_back(i);
+	}
+	API_TEST01(mv, sv, push_back, 6);
+	API_TEST01(mv, sv, emplace_back, 7);
+	API_TEST13(mv, sv, insert, begin, , 0, 3, 5);
+	API_TEST12(mv, sv, insert, begin, , 1, 7);
+	API_TEST_EACH3(mv, sv, insert, mv.begin() + 2, src, src + 6, sv.begin() + 2, src, src + 6);
+	API_TEST22(mv, sv, erase, begin, begin, , 1, , 3);
+	API_TEST11(mv, sv, erase, begin, , 2);
+	API_TEST01(mv, sv, pop_back, );
+	API_CHECK("size", mv.size() == sv.size() && mv.back() == sv.back());
+}
+
+static_assert(std::is_trivially_copyable<static_vector<int, 16>>::value, "static_vector of int must be trivially copyable");
+
+inline bool static_vector_overflow() {
+	static_vector<int, 4> v(4, 1);
+	try {
+		v.push_back(2);
+	}
+	catch (std::out_of_range&) {
+		return v.size() == 4;
+	}
+	return false;
+}
+
+//写入文件后以只读方式重新打开，内容应与写入时相同，且不能再修改
+inline bool mmap_vector_reopen(const char* path, const std::vector<int>& expect) {
+	mmap_vector<int> mv(path, mmap_read_only);
+	if (mv.size() != expect.size() || !std::equal(expect.begin(), expect.end(), mv.begin()))
+		return false;
+	try {
+		mv.push_back(1);
+	}
+	catch (std::runtime_error&) {
+		return !mv.writable();
+	}
+	return false;
+}
+
+//扩容时参数引用容器自己的元素，新行要在旧列释放之前构造好
+inline bool soa_vector_alias() {
+	soa_vector<std::string, int> v;
+	v.push_back(std::string(40, 'x'), 0);
+	for (int i = 1; i < 100; ++i) {
+		if (i % 2)
+			v.push_back(std::get<0>(v[0]), std::get<1>(v.back()) + 1);
+		else
+			v.emplace_back(std::get<0>(v.back()), std::get<1>(v[i - 1]) + 1);
+	}
+	for (int i = 0; i < 100; ++i)
+		if (std::get<0>(v[i]) != std::string(40, 'x') || std::get<1>(v[i]) != i)
+			return false;
+	return true;
+}
+
+//第二列构造时抛出异常，扩容中途失败后原有的行和容量不变
+struct __soa_throw {
+	int v;
+	__soa_throw(int x): v(x) {
+		if (x < 0)
+			throw std::runtime_error("negative field");
+	}
+};
+
+inline bool soa_vector_throw_keeps() {
+	soa_vector<std::string, __soa_throw> v;
+	for (int i = 0; i < 8; ++i)
+		v.emplace_back(std::to_string(i), i);
+	v.shrink_to_fit();
+	const size_t cap = v.capacity();
+	try {
+		v.emplace_back("bad", -1);
+		return false;
+	}
+	catch (std::runtime_error&) {}
+	if (v.size() != 8 || v.capacity() != cap)
+		return false;
+	for (int i = 0; i < 8; ++i)
+		if (std::get<0>(v[i]) != std::to_string(i) || std::get<1>(v[i]).v != i)
+			return false;
+	return true;
+}
+
+//逐位、count、rank、find_first/find_next都与vector<bool>一致，最后一个字中超出size()的位为0
+inline bool bit_vector_matches(const bit_vector& b, const std::vector<bool>& v) {
+	if (b.size() != v.size())
+		return false;
+	size_t ones = 0, next = b.find_first();
+	for (size_t i = 0; i < v.size(); ++i) {
+		if (b.test(i) != v[i] || b.rank(i) != ones)
+			return false;
+		if (v[i]) {
+			if (next != i)
+				return false;
+			next = b.find_next(i);
+			++ones;
+		}
+	}
+	if (next != bit_vector::npos || b.count() != ones || b.rank(v.size()) != ones || b.all() != (ones == v.size()))
+		return false;
+	return !(b.size() % __BIT_WORD_BITS) || (b.data()[b.words() - 1] >> (b.size() % __BIT_WORD_BITS)) == 0;
+}
+
+//随机的push_back、pop_back、resize（带值）、flip、set，跨过字边界后与vector<bool>比较
+inline bool bit_vector_random(unsigned seed) {
+	srand(seed);
+	bit_vector b;
+	std::vector<bool> v;
+	for (int step = 0; step < 2000; ++step) {
+		const int op = rand() % 10;
+		if (op < 5) {
+			const bool val = rand() % 3 == 0;
+			b.push_back(val);
+			v.push_back(val);
+		}
+		else if (op == 5 && !v.empty()) {
+			b.pop_back();
+			v.pop_back();
+		}
+		else if (op == 6) {
+			const size_t n = rand() % 300;
+			const bool val = rand() % 2 == 0;
+			b.resize(n, val);
+			v.resize(n, val);
+		}
+		else if (op == 7) {
+			b.flip();
+			v.flip();
+		}
+		else if (op == 8 && !v.empty()) {
+			const size_t i = rand() % v.size();
+			b.set(i, !v[i]);
+			v[i] = !v[i];
+		}
+		else if (op == 9 && rand() % 8 == 0) {
+			b.set();
+			v.assign(v.size(), true);
+		}
+		if (!bit_vector_matches(b, v))
+			return false;
+	}
+	return true;
+}
+
 void vector_test() {
 	vector<int> mv2(2, 7);
 	std::vector<int> sv2(2, 7);
@@ -29,6 +229,8 @@ void vector_test() {
 	API_TEST11(mv, sv, erase, begin, , 2);
 	API_TEST01(mv, sv, pop_back, );
 	API_TEST22(mv, sv, erase, begin, end, , 0, , 0);
+	API_TEST01(mv, sv, reserve, 100);
+	API_TEST01(mv, sv, shrink_to_fit, );
 	vector<int> mv3(mv2);
 	std::vector<int> sv3(sv2);
 	API_TEST_EACH1(mv, sv, swap, mv3, sv3);
@@ -51,13 +253,107 @@ void vector_test() {
 	API_TEST_EACH3(msv, ssv, insert, msv.begin(), msv2.begin(), msv2.end(), ssv.begin(), ssv2.begin(), ssv2.end());
 	API_TEST11(msv, ssv, erase, begin, , 2);
 	API_TEST01(msv, ssv, pop_back, );
+	API_TEST01(msv, ssv, reserve, 100);
+	API_TEST01(msv, ssv, shrink_to_fit, );
 	msv.clear();
 	ssv.clear();
+	API_CHECK("uninitialized_relocate forward overlap", relocate_overlap(4, 2));
+	API_CHECK("uninitialized_relocate backward overlap", relocate_overlap(4, -2));
+	API_CHECK("uninitialized_move without assignment", move_no_assign());
+	cout << "[---------------- Container test : small_vector ----------------]\n";
+	small_vector<int, 8> msmall;
+	vector_like_test(msmall);
+	small_vector<int, 8> msmall2(3, 4);
+	std::vector<int> ssmall2(3, 4);
+	API_CHECK("small_vector stays inline", msmall2.is_inline() && !msmall.is_inline());
+	msmall2.swap(msmall);
+	API_COMPARE(msmall, ssmall2);
+	small_vector<int, 8> msmall3(lmstl::move(msmall2));
+	API_CHECK("small_vector move from heap", msmall2.empty() && msmall2.is_inline() && msmall3.size() > 8);
+	small_vector<std::string, 2> mssmall;
+	std::vector<std::string> sssmall;
+	for (int i = 0; i < 5; ++i) {
+		mssmall.push_back(std::string(20, char('a' + i)));
+		sssmall.push_back(std::string(20, char('a' + i)));
+	}
+	API_TEST12(mssmall, sssmall, insert, begin, , 1, "ins");
+	API_TEST22(mssmall, sssmall, erase, begin, begin, , 0, , 2);
+	cout << "[--------------- Container test : static_vector ----------------]\n";
+	static_vector<int, 64> mstatic;
+	vector_like_test(mstatic);
+	static_vector<int, 64> mstatic2(mstatic);
+	std::vector<int> sstatic2(mstatic.begin(), mstatic.end());
+	API_COMPARE(mstatic2, sstatic2);
+	API_CHECK("static_vector capacity exceeded", static_vector_overflow());
+	static_vector<std::string, 8> msstatic(3, "A");
+	std::vector<std::string> ssstatic(3, "A");
+	API_TEST12(msstatic, ssstatic, insert, begin, , 1, "ins");
+	API_TEST13(msstatic, ssstatic, insert, begin, , 0, 2, "two");
+	API_TEST22(msstatic, ssstatic, erase, begin, begin, , 1, , 3);
+	static_vector<std::string, 8> msstatic2(lmstl::move(msstatic));
+	API_COMPARE(msstatic2, ssstatic);
+	cout << "[---------------- Container test : mmap_vector -----------------]\n";
+	const char* mmap_path = "mmap_vector_test.bin";
+	std::remove(mmap_path);
+	std::vector<int> smmap;
+	{
+		mmap_vector<int> mmmap(mmap_path);
+		vector_like_test(mmmap);
+		for (int i = 0; i < 100000; ++i)
+			mmmap.push_back(i);
+		smmap.assign(mmmap.begin(), mmmap.end());
+		API_TEST01(mmmap, smmap, resize, 50);
+		API_TEST01(mmmap, smmap, shrink_to_fit, );
+	}
+	API_CHECK("mmap_vector reopen read-only", mmap_vector_reopen(mmap_path, smmap));
+	std::remove(mmap_path);
+	cout << "[---------------- Container test : soa_vector ------------------]\n";
+	soa_vector<int, std::string> msoa;
+	std::vector<int> ssoa_id;
+	std::vector<std::string> ssoa_name;
+	for (int i = 0; i < 1000; ++i) {
+		msoa.push_back(i, std::to_string(i));
+		ssoa_id.push_back(i);
+		ssoa_name.push_back(std::to_string(i));
+	}
+	msoa.erase(msoa.begin() + 10, msoa.begin() + 20);
+	ssoa_id.erase(ssoa_id.begin() + 10, ssoa_id.begin() + 20);
+	ssoa_name.erase(ssoa_name.begin() + 10, ssoa_name.begin() + 20);
+	span<int> msoa_id = msoa.column<0>();
+	span<std::string> msoa_name = msoa.column<1>();
+	API_CHECK("soa_vector size", msoa.size() == ssoa_id.size() && msoa_id.size() == ssoa_id.size());
+	API_COMPARE(msoa_id, ssoa_id);
+	API_COMPARE(msoa_name, ssoa_name);
+	msoa.resize(5);
+	msoa.push_back(std::make_tuple(7, std::string("seven")));
+	API_CHECK("soa_vector resize and push_back tuple", msoa.size() == 6 && std::get<1>(msoa.back()) == "seven");
+	API_CHECK("soa_vector push_back aliasing an element", soa_vector_alias());
+	API_CHECK("soa_vector keeps rows when a field throws", soa_vector_throw_keeps());
+	cout << "[---------------- Container test : bit_vector ------------------]\n";
+	bit_vector mbits(130, true);
+	std::vector<bool> sbits(130, true);
+	API_CHECK("bit_vector fill constructor", bit_vector_matches(mbits, sbits));
+	mbits.resize(64);
+	sbits.resize(64);
+	mbits.resize(200, false);
+	sbits.resize(200, false);
+	API_CHECK("bit_vector shrink then grow clears the tail", bit_vector_matches(mbits, sbits));
+	mbits.resize(70);
+	sbits.resize(70);
+	mbits.resize(129, true);
+	sbits.resize(129, true);
+	API_CHECK("bit_vector resize with true inside a word", bit_vector_matches(mbits, sbits));
+	bit_vector mbits2 = ~mbits;
+	std::vector<bool> sbits2(sbits);
+	sbits2.flip();
+	API_CHECK("bit_vector operator~ keeps the tail clear", bit_vector_matches(mbits2, sbits2));
+	API_CHECK("bit_vector random operations", bit_vector_random(1) && bit_vector_random(2) && bit_vector_random(3));
 	API_TEST_END();
 	PERF_TEST_START();
 	cout << "[------------------- Container test : vector -------------------]\n";
 	PERF_TEST00(vector, push_back, 500000, 1000000, 10000000);
 	PERF_TEST00(vector, emplace_back, 500000, 1000000, 10000000);
+	PERF_TEST01(vector, malloc_alloc, push_back, 5000000, 10000000, 50000000);
 	PERF_TEST11(vector, insert, begin, 10000, 30000, 100000);
 	PERF_TEST_END();
 }